@@ -0,0 +1,269 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_ASYNCWRITER_HPP
+#define HEADERLOCK_ASYNCWRITER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Background writer for host builds: producers format with AsyncWriter::Builder into buffers taken
+ *  from a free list, a full buffer is handed to a writer thread in exchange for a free one and the
+ *  thread writes everything handed over since its last write with one writev() to a file descriptor.
+ *  Buffers go back to the free list, nothing is allocated after the construction. A producer does not
+ *  wait for the disk: if no buffer is free its text is dropped and counted, unless the writer is made
+ *  blocking. Text is handed over in whole lines, so lines of different producers are not mixed.
+ *  Each Builder holds one buffer, BUFFERS has to be larger than the number of builders */
+template <std::size_t BUFFERS = 8, std::size_t BUFFER_SIZE = 4096>
+class AsyncWriter {
+    static_assert(BUFFERS >= 2, "AsyncWriter needs at least 2 buffers");
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+private:
+    static const std::size_t NONE = BUFFERS;
+
+    char _buffers[BUFFERS][BUFFER_SIZE];
+    std::size_t _lengths[BUFFERS];
+    std::size_t _free[BUFFERS];         /* stack of free buffers */
+    std::size_t _freeCount;
+    std::size_t _queue[BUFFERS];        /* full buffers in hand over order */
+    std::size_t _queueHead;
+    std::size_t _queueCount;
+    std::size_t _dropped;
+    bool _writing;
+    bool _stop;
+    bool _block;
+    int _fd;
+
+    std::mutex _mutex;
+    std::condition_variable _ready;     /* full buffers or stop for the writer thread */
+    std::condition_variable _freed;     /* free buffers for producers */
+    std::thread _thread;
+
+    std::size_t acquire(bool wait)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if(wait) _freed.wait(lock, [this]() { return _freeCount > 0; });
+        if(!_freeCount) return NONE;
+        return _free[--_freeCount];
+    }
+
+    /* queues length bytes of the buffer for writing, an empty buffer goes back to the free list */
+    void submit(std::size_t index, std::size_t length)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(length == 0) {
+                _free[_freeCount++] = index;
+                _freed.notify_one();
+                return;
+            }
+            _lengths[index] = length;
+            _queue[(_queueHead + _queueCount++) % BUFFERS] = index;
+        }
+        _ready.notify_one();
+    }
+
+    void drop(std::size_t size)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _dropped += size;
+    }
+
+    /* writes the batch, returns the bytes that could not be written */
+    std::size_t write_all(struct iovec* iov, std::size_t n)
+    {
+        while(n) {
+            ssize_t written = ::writev(_fd, iov, (int)n);
+            if(written < 0) {
+                if(errno == EINTR) continue;
+
+                std::size_t lost = 0;
+                for(std::size_t i = 0; i < n; i++) lost += iov[i].iov_len;
+                return lost;
+            }
+
+            /* a short write goes on from where it stopped */
+            std::size_t done = (std::size_t)written;
+            while(n && done >= iov->iov_len) {
+                done -= iov->iov_len;
+                iov++;
+                n--;
+            }
+            if(n) {
+                iov->iov_base = (char*)iov->iov_base + done;
+                iov->iov_len -= done;
+            }
+        }
+        return 0;
+    }
+
+    void run()
+    {
+        struct iovec iov[BUFFERS];
+        std::size_t taken[BUFFERS];
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for(;;) {
+            _ready.wait(lock, [this]() { return _queueCount > 0 || _stop; });
+            if(!_queueCount) break;
+
+            /* everything queued goes in one writev() */
+            std::size_t n = _queueCount;
+            for(std::size_t i = 0; i < n; i++) {
+                taken[i] = _queue[(_queueHead + i) % BUFFERS];
+                iov[i].iov_base = _buffers[taken[i]];
+                iov[i].iov_len = _lengths[taken[i]];
+            }
+            _queueHead = (_queueHead + n) % BUFFERS;
+            _queueCount = 0;
+            _writing = true;
+
+            lock.unlock();
+            std::size_t lost = write_all(iov, n);
+            lock.lock();
+
+            _dropped += lost;
+            for(std::size_t i = 0; i < n; i++) _free[_freeCount++] = taken[i];
+            _writing = false;
+            _freed.notify_all();
+        }
+    }
+
+public:
+    /** Writes to fd, which stays open. With block a producer waits for a free buffer instead of dropping */
+    explicit AsyncWriter(int fd, bool block = false): _freeCount(BUFFERS), _queueHead(0), _queueCount(0), _dropped(0),
+            _writing(false), _stop(false), _block(block), _fd(fd)
+    {
+        for(std::size_t i = 0; i < BUFFERS; i++) _free[i] = BUFFERS - 1 - i;
+        _thread = std::thread(&AsyncWriter::run, this);
+    }
+
+    /** Writes what was handed over and stops the thread, builders have to be gone by then */
+    ~AsyncWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _ready.notify_one();
+        _thread.join();
+    }
+
+    /** Waits until everything handed over is written */
+    void wait_idle()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _freed.wait(lock, [this]() { return _queueCount == 0 && !_writing; });
+    }
+
+    /** Bytes dropped for lack of a free buffer or lost to write errors */
+    std::size_t dropped()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _dropped;
+    }
+
+    /** Producer side, one per thread. The builder's buffer is a window that starts after a line
+     *  carried over from the previous buffer. The builder takes a buffer when created, waiting for one
+     *  if none is free, and hands over what is left on destruction */
+    class Builder : public CStringBuilder {
+        Builder(const Builder&) = delete;
+        Builder& operator=(const Builder&) = delete;
+
+    private:
+        AsyncWriter& _writer;
+        std::size_t _index;
+        char _none[1];
+
+        char* base() { return _writer._buffers[_index]; }
+        std::size_t length() { return (std::size_t)(_buffer - base()) + _cursor; }
+
+        static void on_flush(CStringBuilder&, void* context)
+        {
+            static_cast<Builder*>(context)->hand_over(true);
+        }
+
+        /* swaps the buffer for a free one, a started line is carried over unless it is too long */
+        void hand_over(bool keepLine)
+        {
+            char* text = base();
+            std::size_t length = this->length();
+            std::size_t cut = length;
+
+            if(keepLine) {
+                std::size_t line = length;
+                while(line > 0 && text[line - 1] != '\n') line--;
+                if(line > 0 && length - line <= BUFFER_SIZE / 2) cut = line;
+            }
+
+            std::size_t tail = length - cut;
+            std::size_t next = _writer.acquire(_writer._block);
+
+            if(next == NONE) {
+                _writer.drop(cut);
+                std::memmove(text, text + cut, tail);
+            } else {
+                std::memcpy(_writer._buffers[next], text + cut, tail);
+                _writer.submit(_index, cut);
+                _index = next;
+            }
+
+            rebind(base() + tail, BUFFER_SIZE - tail);
+        }
+
+    public:
+        explicit Builder(AsyncWriter& writer): CStringBuilder(_none, 1), _writer(writer), _index(writer.acquire(true))
+        {
+            rebind(base(), BUFFER_SIZE);
+            set_flush_hook(on_flush, this);
+        }
+
+        ~Builder() { _writer.submit(_index, length()); }
+
+        /** Hands everything added so far to the writer thread */
+        void flush() { if(length()) hand_over(false); }
+    };
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //defined(__unix__) || defined(__APPLE__)
+
+#endif //HEADERLOCK_ASYNCWRITER_HPP
@@ -47,6 +47,87 @@ SOFTWARE.
 #define TCSB_USE_SEPARATOR 0
 #endif
 
+// Compact power-of-ten cache for tiny flash parts: only every 4th cached power is stored and the rest
+// is reconstructed with one extra multiply by an exact 10^8, 10^16 or 10^24 and a +-1 correction.
+// Tables: 1392 bytes by default, 248 bytes in compact mode (plus 160 bytes of tens() in both modes)
+#if !defined( TCSB_FP_COMPACT_POWERS )
+    #define TCSB_FP_COMPACT_POWERS (0)
+#endif
+
+// Allows to place floating point tables into a named linker section, e.g.
+// #define TCSB_FP_TABLE_SECTION ".rodata.tcsb"
+// The section must hold read-only data only (mixing with writable data is a "section type conflict")
+#if defined( TCSB_FP_TABLE_SECTION )
+    #define TCSB_FP_TABLE_ATTR __attribute__((section(TCSB_FP_TABLE_SECTION)))
+#else
+    #define TCSB_FP_TABLE_ATTR
+#endif
+
+// Allows to switch off compiler intrinsics (128-bit multiply, count leading zeros) in the floating point core.
+// Portable code is used as a fallback where intrinsics are not available
+#if !defined( TCSB_USE_INTRINSICS )
+    #define TCSB_USE_INTRINSICS (1)
+#endif
+
+#if TCSB_USE_FP && TCSB_USE_INTRINSICS
+    #if defined(__SIZEOF_INT128__)
+        #define TCSB_HAS_UINT128 1              // GCC/Clang 64-bit targets: mul/umulh pair on x86-64 and AArch64
+    #elif defined(_MSC_VER) && defined(_M_X64)
+        #include <intrin.h>
+        #pragma intrinsic(_umul128)
+        #define TCSB_HAS_UMUL128 1
+    #elif defined(_MSC_VER) && defined(_M_ARM64)
+        #include <intrin.h>
+        #pragma intrinsic(__umulh)
+        #define TCSB_HAS_UMULH 1
+    #endif
+
+    #if defined(__GNUC__) || defined(__clang__)
+        #define TCSB_HAS_CLZ 1
+    #elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        #include <intrin.h>
+        #pragma intrinsic(_BitScanReverse64)
+        #define TCSB_HAS_CLZ 1
+    #endif
+#endif
+
+// Allows to switch off 8-chars-at-a-time (SWAR) scanning. It is used on little endian targets only
+#if !defined( TCSB_USE_SWAR )
+    #define TCSB_USE_SWAR (1)
+#endif
+
+#if TCSB_USE_SWAR && TCSB_USE_INTRINSICS
+    #if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        #define TCSB_HAS_SWAR 1
+    #elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        #include <intrin.h>
+        #pragma intrinsic(_BitScanForward64)
+        #define TCSB_HAS_SWAR 1
+    #endif
+#endif
+
+// Allows to switch off running checksums (XOR, CRC-16/CCITT, CRC-32C) of the added text.
+// CRC tables take 512 + 1024 bytes, CRC-32C uses no table with SSE4.2 or ARMv8 CRC instructions
+#if !defined( TCSB_USE_CHECKSUM )
+    #define TCSB_USE_CHECKSUM (1)
+#endif
+
+#if TCSB_USE_CHECKSUM && TCSB_USE_INTRINSICS
+    #if defined(__SSE4_2__)
+        #include <nmmintrin.h>
+        #define TCSB_HAS_CRC32C 1
+    #elif defined(__ARM_FEATURE_CRC32)
+        #include <arm_acle.h>
+        #define TCSB_HAS_CRC32C 1
+    #endif
+#endif
+
+// SSSE3 kernels for binary to text encodings, used when the compiler targets SSSE3 (-mssse3, -march=native)
+#if TCSB_USE_INTRINSICS && defined(__SSSE3__)
+    #include <tmmintrin.h>
+    #define TCSB_HAS_SSSE3 1
+#endif
+
 // Keil UVision and some other controller compilers happen to have problems with namespaces (and nested namespaces)
 // TCSB_USE_NAMESPACE allows to exclude tcsb namespace from the class. Namespace is used by default
 #if !defined( TCSB_NO_NAMESPACE )
@@ -60,22 +141,202 @@ typedef struct TCSB_Fp {
 } TCSB_Fp;
 #endif  //#if TCSB_USE_FP
 
+#if TCSB_HAS_SWAR
+#define TCSB_swar_ones   0x0101010101010101ULL
+#define TCSB_swar_highs  0x8080808080808080ULL
+
+/* 8 chars at a time in a uint64_t, the first char is the lowest byte.
+ * Masks have the high bit set in every flagged byte, only the first flagged byte is exact */
+struct TCSB_Swar {
+    static inline uint64_t load(const char* s)
+    {
+        uint64_t chunk;
+        std::memcpy(&chunk, s, 8);
+        return chunk;
+    }
+
+    static inline uint64_t zero_bytes(uint64_t chunk)
+    {
+        return (chunk - TCSB_swar_ones) & ~chunk & TCSB_swar_highs;
+    }
+
+    static inline uint64_t bytes_equal(uint64_t chunk, char c)
+    {
+        return zero_bytes(chunk ^ (TCSB_swar_ones * (unsigned char)c));
+    }
+
+    /* bytes below n, n <= 128 */
+    static inline uint64_t bytes_less(uint64_t chunk, unsigned char n)
+    {
+        return (chunk - TCSB_swar_ones * n) & ~chunk & TCSB_swar_highs;
+    }
+
+    /* bytes in (m, n), exact for every byte, m < n <= 128 */
+    static inline uint64_t bytes_between(uint64_t chunk, unsigned char m, unsigned char n)
+    {
+        uint64_t low = chunk & (TCSB_swar_ones * 127);
+        return (TCSB_swar_ones * (127 + n) - low) & ~chunk & (low + TCSB_swar_ones * (127 - m)) & TCSB_swar_highs;
+    }
+
+    /* index of the first flagged byte, mask must not be 0 */
+    static inline int first(uint64_t mask)
+    {
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(mask) >> 3;
+    #else
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return (int)index >> 3;
+    #endif
+    }
+};
+#endif  //#if TCSB_HAS_SWAR
+
 
 class CStringBuilder {
     CStringBuilder(const CStringBuilder&) = delete;
     CStringBuilder& operator=(const CStringBuilder&) = delete;
 
-private:
+    friend class CStringParser;     // shares cached powers of ten and multiply() for float parsing
+    friend class ParallelFormat;    // writes straight into the buffer from many threads
+
+public:
+#if TCSB_USE_FP
+    /** Floating point notation used by addf */
+    enum FpNotation {
+        FP_AUTO,            /// plain or scientific, whichever is shorter: 3.14, 3e-7, 3e+12
+        FP_SCIENTIFIC,      /// always exponent form: 3.14e+0
+        FP_ENGINEERING,     /// exponent is a multiple of 3: 12.5e-6
+        FP_SI               /// SI prefix instead of exponent: 12.5u, 4.7k (engineering out of y..Y)
+    };
+
+    /** Longest text a double takes in any notation: sign, 17 digits and 7 zeros, -123456789012345670000000 */
+    static const std::size_t FP_MAX_LENGTH = 25;
+#endif
+
+#if TCSB_USE_CHECKSUM
+    /** Running checksum of the added text */
+    enum ChecksumType {
+        CHECKSUM_NONE,
+        CHECKSUM_XOR8,          /// XOR of all bytes, as in NMEA 0183
+        CHECKSUM_CRC16_CCITT,   /// CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF
+        CHECKSUM_CRC32C         /// CRC-32C (Castagnoli), as in iSCSI and ext4
+    };
+#endif
+
+    /** Called after every write with the position the new bytes start at. Derived builders use it
+     *  to encode or watch the output in place: the hook may rewrite the new bytes and move the cursor
+     *  but must keep it below buffer_size() */
+    typedef void (*WriteHook)(CStringBuilder& sb, std::size_t from, void* context);
+
+    /** Called by a streaming builder when it is full: the hook takes cstr() and size() out
+     *  and the builder goes on from the beginning of the buffer */
+    typedef void (*FlushHook)(CStringBuilder& sb, void* context);
+
+protected:
     char* _buffer;
     char _separator = ' ';
+#if TCSB_USE_FP
+    FpNotation _fpNotation = FP_AUTO;
+#endif
     std::size_t _bufferSize;
     std::size_t _cursor;
     bool _isOverflow;
+    std::size_t _reserved = 0;      /* bytes at the end of the buffer adds leave alone, e.g. for a frame delimiter */
+
+    WriteHook _writeHook = nullptr;
+    void* _writeHookContext = nullptr;
+    std::size_t _hookCursor = 0;    /* bytes before it are already passed to the checksum and the hook */
+
+    FlushHook _flushHook = nullptr;
+    void* _flushHookContext = nullptr;
+
+#if TCSB_USE_CHECKSUM
+    ChecksumType _checksumType = CHECKSUM_NONE;
+    bool _checksumRunning = false;
+    uint32_t _checksum = 0;
+#endif
+
+    void set_write_hook(WriteHook hook, void* context)
+    {
+        _writeHook = hook;
+        _writeHookContext = context;
+        _hookCursor = _cursor;
+    }
+
+    /* points the builder to another buffer and starts over with an empty string */
+    void rebind(char* buffer, std::size_t bufferSize)
+    {
+        _buffer = buffer;
+        _bufferSize = bufferSize;
+        _cursor = 0;
+        _hookCursor = 0;
+        _isOverflow = false;
+        _reserved = 0;
+        _buffer[0] = '\0';
+    }
+
+    void set_flush_hook(FlushHook hook, void* context)
+    {
+        _flushHook = hook;
+        _flushHookContext = context;
+    }
+
+    /* hands the text to the flush hook and starts from the beginning,
+     * false if there is no hook or nothing to flush */
+    bool flush_buffer()
+    {
+        if(!_flushHook || !_cursor) return false;
 
+        set_string_end();
+        _flushHook(*this, _flushHookContext);
+        _cursor = 0;
+        _hookCursor = 0;
+        _buffer[0] = '\0';
+        return true;
+    }
+
+    /* end of the buffer for adds */
+    std::size_t write_limit() { return _bufferSize - _reserved; }
+
+    /* true if size more chars fit, a streaming builder is flushed to make room */
+    bool make_room(std::size_t size)
+    {
+        if(write_limit() - 1 - _cursor >= size) return true;
+        return flush_buffer() && write_limit() - 1 >= size;
+    }
+
+    /* chars add_integer writes for n, digits are counted 4 at a time from the magnitude */
+    template <typename IntType>
+    static std::size_t integer_length(IntType n)
+    {
+        typedef typename std::make_unsigned<IntType>::type UIntType;
+        UIntType u = n < 0 ? (UIntType)(0 - (UIntType)n) : (UIntType)n;
+        std::size_t length = n < 0 ? 2 : 1;
+
+        for(; u >= 10000; u /= 10000) length += 4;
+        return length + (u >= 10) + (u >= 100) + (u >= 1000);
+    }
+
+    /* every write path ends here */
     void set_string_end() {
+        if(_hookCursor < _cursor) {
+#if TCSB_USE_CHECKSUM
+            if(_checksumRunning) update_checksum(&_buffer[_hookCursor], _cursor - _hookCursor);
+#endif
+            if(_writeHook) {
+                WriteHook hook = _writeHook;
+                _writeHook = nullptr;       /* writes from the hook itself are not passed back */
+                hook(*this, _hookCursor, _writeHookContext);
+                _writeHook = hook;
+            }
+            _hookCursor = _cursor;
+        }
         _buffer[_cursor] = '\0';
     }
 
+private:
+
     /* reverse:  reverse string s in place */
     void reverse(char s[])
     {
@@ -124,19 +385,22 @@ public:
     template <typename IntType>
     size_t add_integer(IntType n)
     {
-        if (_bufferSize - 1 <= _cursor) return 0;
+        if(_flushHook && write_limit() - 1 - _cursor < 20) make_room(integer_length(n));   /* a number is never split */
+        if (write_limit() - 1 <= _cursor) return 0;
         size_t i;
         bool isNegative;
         char *s = &_buffer[_cursor];
 
-        /* record sign */
+        /* record sign, digits come from the unsigned magnitude so that the minimum value works too */
+        typedef typename std::make_unsigned<IntType>::type UIntType;
+        UIntType u = (UIntType)n;
         isNegative = n < 0;
         if (isNegative) {
             _cursor++; /* increase length fo 1 */
-            n = -n; /* make n positive */
+            u = (UIntType)(0 - u); /* make n positive */
 
             // Check buffer overflow
-            if(_bufferSize - 1 <= _cursor) {
+            if(write_limit() - 1 <= _cursor) {
                 set_string_end();
                 return 1;
             }
@@ -145,15 +409,16 @@ public:
         i = 0;
         do {
             /* generate digits in reverse order */
-            s[i++] = n % 10 + '0'; /* get next digit */
-            n /= 10;
+            s[i++] = u % 10 + '0'; /* get next digit */
+            u /= 10;
 
             _cursor++;
 
-        } while (n > 0 && _cursor < _bufferSize - 1);     /* delete it */
+        } while (u > 0 && _cursor < write_limit() - 1);     /* delete it */
 
-        // Check buffer overflow
-        if(_bufferSize - 1 <= _cursor) {
+        // Check buffer overflow: digits are left (a number that just fits is not an overflow)
+        if(u > 0) {
+            _isOverflow = true;
             set_string_end();
             return 1;
         }
@@ -165,6 +430,7 @@ public:
 
         s[i] = '\0';
         reverse(s);
+        set_string_end();
         return i;
     }
 
@@ -181,14 +447,21 @@ public:
     char * cstr() { return _buffer;}
 
 
+    /** true if something did not fit into the buffer and was cut or dropped */
+    bool is_overflow(void) { return _isOverflow; }
+
+    /** Marks the text as cut, for a writer over the builder that drops something on its own */
+    void set_overflow(void) { _isOverflow = true; }
+
+
     /** Append by C string */
     template<class CharConstPtr>
     size_t add(CharConstPtr array, std::size_t size) {
-        if(_bufferSize - 1 == _cursor) return 0;
+        if(write_limit() - 1 == _cursor && !make_room(1)) return 0;
         size_t i;
 
         for(i=0; array[i] != (char)'\0' && i<size ; i++) {
-            if(_bufferSize - 1 == _cursor) break;
+            if(write_limit() - 1 == _cursor && !make_room(1)) break;
             _buffer[_cursor] = array[i];
             _cursor++;
         }
@@ -202,10 +475,30 @@ public:
         return add(&array[0], SIZE);
     }
 
+    /** Appends exactly size bytes (no '\0' check) with one memcpy, cuts what does not fit */
+    size_t add_bytes(const char* data, std::size_t size)
+    {
+        std::size_t added = 0;
+
+        while(true) {
+            std::size_t room = write_limit() - 1 - _cursor;
+            std::size_t chunk = size - added < room ? size - added : room;
+
+            std::memcpy(&_buffer[_cursor], data + added, chunk);
+            _cursor += chunk;
+            added += chunk;
+            if(added == size || !make_room(1)) break;
+        }
+
+        if(added < size) _isOverflow = true;
+        set_string_end();
+        return added;
+    }
+
     /// Adds char to the buffer
     size_t add(char value)
     {
-        if (_bufferSize - 1 == _cursor) return 0;
+        if (write_limit() - 1 == _cursor && !make_room(1)) return 0;
         _buffer[_cursor] = (char)value;
         _cursor++;
         set_string_end();
@@ -222,6 +515,570 @@ public:
     size_t add(int64_t value)  { return add_integer<int64_t>(value); }    /// Converts int64_t to string and adds to the buffer
     size_t add(uint64_t value) { return add_integer<uint64_t>(value); }   /// Converts uint64_t to string and adds to the buffer
 
+    /*----------------- BINARY TO TEXT -----------------------*/
+private:
+    static const char* base64_alphabet(bool url)
+    {
+        static const char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        return url ? alphabet + 64 : alphabet;
+    }
+
+#if TCSB_HAS_SSSE3
+    /* 12 bytes (16 must be readable) to 16 chars, http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html */
+    static inline void base64_ssse3(const unsigned char* src, char* dest, bool url)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i*)src);
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+        /* split 3 bytes into 4 6-bit indices, one per byte */
+        __m128i hi = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i lo = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(hi, lo);
+
+        /* index ranges A-Z, a-z, 0-9, and the two last chars get their own offsets */
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        url ? '-' - 62 : '+' - 62, url ? '_' - 63 : '/' - 63, 'A', 0, 0);
+
+        _mm_storeu_si128((__m128i*)dest, _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range)));
+    }
+#endif //#if TCSB_HAS_SSSE3
+
+    static std::size_t base64_length(std::size_t size, bool pad)
+    {
+        std::size_t tail = size % 3;
+        return size / 3 * 4 + (tail ? (pad ? 4 : tail + 1) : 0);
+    }
+
+    size_t encode_base64(const void* data, std::size_t size, bool url, bool pad)
+    {
+        const unsigned char* src = (const unsigned char*)data;
+        std::size_t added = 0;
+
+        /* a streaming builder sends the whole groups that fit and goes on from an empty buffer */
+        while(_flushHook && base64_length(size, pad) > write_limit() - 1 - _cursor) {
+            std::size_t groups = (write_limit() - 1 - _cursor) / 4;
+            if(groups > size / 3) groups = size / 3;
+
+            added += encode_base64_part(src, groups * 3, url, pad);
+            src += groups * 3;
+            size -= groups * 3;
+            if(!flush_buffer()) break;
+        }
+
+        return added + encode_base64_part(src, size, url, pad);
+    }
+
+    size_t encode_base64_part(const unsigned char* src, std::size_t size, bool url, bool pad)
+    {
+        const char* alphabet = base64_alphabet(url);
+        std::size_t room = write_limit() - 1 - _cursor;
+        std::size_t groups = size / 3;
+        std::size_t tail = size % 3;
+        std::size_t length = base64_length(size, pad);
+
+        /* cut on a 4 chars boundary, so that what is written decodes to a prefix of data */
+        if(length > room) {
+            _isOverflow = true;
+            if(groups > room / 4) groups = room / 4;
+            tail = 0;
+            length = groups * 4;
+        }
+
+        char* dest = &_buffer[_cursor];
+        std::size_t i = 0;
+
+#if TCSB_HAS_SSSE3
+        for(; i + 4 <= groups && i * 3 + 16 <= size; i += 4) {
+            base64_ssse3(src, dest, url);
+            src += 12;
+            dest += 16;
+        }
+#endif
+        for(; i < groups; i++) {
+            uint32_t v = (uint32_t)src[0] << 16 | (uint32_t)src[1] << 8 | src[2];
+            dest[0] = alphabet[v >> 18];
+            dest[1] = alphabet[(v >> 12) & 63];
+            dest[2] = alphabet[(v >> 6) & 63];
+            dest[3] = alphabet[v & 63];
+            src += 3;
+            dest += 4;
+        }
+
+        if(tail) {
+            uint32_t v = (uint32_t)src[0] << 16 | (tail == 2 ? (uint32_t)src[1] << 8 : 0);
+            dest[0] = alphabet[v >> 18];
+            dest[1] = alphabet[(v >> 12) & 63];
+            if(tail == 2) dest[2] = alphabet[(v >> 6) & 63];
+            else if(pad) dest[2] = '=';
+            if(pad) dest[3] = '=';
+        }
+
+        _cursor += length;
+        set_string_end();
+        return length;
+    }
+
+    /* two hex digits per byte */
+    static const char* hex_pairs()
+    {
+        static const char pairs[] =
+            "000102030405060708090A0B0C0D0E0F"
+            "101112131415161718191A1B1C1D1E1F"
+            "202122232425262728292A2B2C2D2E2F"
+            "303132333435363738393A3B3C3D3E3F"
+            "404142434445464748494A4B4C4D4E4F"
+            "505152535455565758595A5B5C5D5E5F"
+            "606162636465666768696A6B6C6D6E6F"
+            "707172737475767778797A7B7C7D7E7F"
+            "808182838485868788898A8B8C8D8E8F"
+            "909192939495969798999A9B9C9D9E9F"
+            "A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+            "B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+            "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+            "D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+            "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+            "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+        return pairs;
+    }
+
+    static inline void add_hex_pair(char* dest, unsigned char byte)
+    {
+        const char* pair = &hex_pairs()[byte * 2];
+        dest[0] = pair[0];
+        dest[1] = pair[1];
+    }
+
+#if TCSB_HAS_SSSE3
+    /* 16 bytes to 32 hex digits with a nibble shuffle */
+    static inline void hex_ssse3(const unsigned char* src, char* dest)
+    {
+        const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                             '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+        __m128i in = _mm_loadu_si128((const __m128i*)src);
+        __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(in, nibble));
+
+        _mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)(dest + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#endif //#if TCSB_HAS_SSSE3
+
+    /* RFC 3986 unreserved chars: A-Z a-z 0-9 - . _ ~ */
+    static inline bool is_url_safe(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+            || c == '-' || c == '.' || c == '_' || c == '~';
+    }
+
+    /* index of the first char to percent-encode, or size */
+    static std::size_t url_safe_run_end(const char* s, std::size_t i, std::size_t size)
+    {
+#if TCSB_HAS_SWAR
+        for(; size - i >= 8; i += 8) {
+            uint64_t chunk = TCSB_Swar::load(s + i);
+            uint64_t safe = TCSB_Swar::bytes_between(chunk, 'a' - 1, 'z' + 1)
+                          | TCSB_Swar::bytes_between(chunk, 'A' - 1, 'Z' + 1)
+                          | TCSB_Swar::bytes_between(chunk, '0' - 1, '9' + 1)
+                          | TCSB_Swar::bytes_between(chunk, '-' - 1, '.' + 1)
+                          | TCSB_Swar::bytes_between(chunk, '_' - 1, '_' + 1)
+                          | TCSB_Swar::bytes_between(chunk, '~' - 1, '~' + 1);
+            uint64_t unsafe = ~safe & TCSB_swar_highs;
+            if(unsafe) return i + TCSB_Swar::first(unsafe);
+        }
+#endif
+        while(i < size && is_url_safe(s[i])) i++;
+        return i;
+    }
+
+    /* index of the first char to escape in XML/HTML text and attributes, or size */
+    static std::size_t xml_safe_run_end(const char* s, std::size_t i, std::size_t size)
+    {
+#if TCSB_HAS_SWAR
+        for(; size - i >= 8; i += 8) {
+            uint64_t chunk = TCSB_Swar::load(s + i);
+            uint64_t mask = TCSB_Swar::bytes_equal(chunk, '&') | TCSB_Swar::bytes_equal(chunk, '<')
+                          | TCSB_Swar::bytes_equal(chunk, '>') | TCSB_Swar::bytes_equal(chunk, '"')
+                          | TCSB_Swar::bytes_equal(chunk, '\'');
+            if(mask) return i + TCSB_Swar::first(mask);
+        }
+#endif
+        for(; i < size; i++) {
+            char c = s[i];
+            if(c == '&' || c == '<' || c == '>' || c == '"' || c == '\'') break;
+        }
+        return i;
+    }
+
+    /* entity for a char found by xml_safe_run_end */
+    static const char* xml_entity(char c)
+    {
+        static const char entities[][7] = { "&amp;", "&lt;", "&gt;", "&quot;", "&#39;" };
+        switch(c) {
+            case '&': return entities[0];
+            case '<': return entities[1];
+            case '>': return entities[2];
+            case '"': return entities[3];
+            default:  return entities[4];
+        }
+    }
+
+public:
+    /** Adds size bytes of data as Base64 (RFC 4648) with '=' padding. If the output does not fit,
+     *  only whole 4 char groups are added */
+    size_t add_base64(const void* data, std::size_t size) { return encode_base64(data, size, false, true); }
+
+    /** Adds size bytes of data as unpadded Base64url ('-' and '_' instead of '+' and '/') */
+    size_t add_base64url(const void* data, std::size_t size) { return encode_base64(data, size, true, false); }
+
+    /** Adds size bytes of data as upper case hex: 0A1BFF, or 0A 1B FF with a separator ('\0' for none).
+     *  If the output does not fit, only whole bytes are added */
+    size_t add_hexbytes(const void* data, std::size_t size, char separator = '\0')
+    {
+        const unsigned char* src = (const unsigned char*)data;
+        std::size_t width = separator ? 3 : 2;
+        std::size_t added = 0;
+
+        /* a streaming builder sends the whole bytes that fit (with a separator after each) and goes on */
+        while(_flushHook && size && size * width - (width - 2) > write_limit() - 1 - _cursor) {
+            std::size_t n = (write_limit() - 1 - _cursor) / width;
+
+            if(n) {
+                added += add_hexbytes_part(src, n, separator);
+                if(separator) _buffer[_cursor++] = separator;
+                added += width - 2;
+            }
+            src += n;
+            size -= n;
+            if(!flush_buffer()) break;
+        }
+
+        return added + add_hexbytes_part(src, size, separator);
+    }
+
+private:
+    size_t add_hexbytes_part(const unsigned char* src, std::size_t size, char separator)
+    {
+        std::size_t room = write_limit() - 1 - _cursor;
+        std::size_t width = separator ? 3 : 2;
+
+        if(size && size * width - (width - 2) > room) {
+            _isOverflow = true;
+            size = (room + (width - 2)) / width;
+        }
+        if(!size) return 0;
+
+        char* dest = &_buffer[_cursor];
+        std::size_t i = 0;
+
+        if(separator) {
+            for(; i < size; i++) {
+                add_hex_pair(dest, src[i]);
+                dest[2] = separator;
+                dest += 3;
+            }
+            dest--;     /* no separator after the last byte */
+        } else {
+#if TCSB_HAS_SSSE3
+            for(; i + 16 <= size; i += 16) {
+                hex_ssse3(src + i, dest);
+                dest += 32;
+            }
+#endif
+            for(; i < size; i++) {
+                add_hex_pair(dest, src[i]);
+                dest += 2;
+            }
+        }
+
+        std::size_t length = dest - &_buffer[_cursor];
+        _cursor += length;
+        set_string_end();
+        return length;
+    }
+
+public:
+    /** Adds a string percent-encoded for a URL query component: all chars but A-Z a-z 0-9 - . _ ~
+     *  become %XX. Clean runs are copied at once, an escape is never cut */
+    size_t add_url_encoded(const char* s, std::size_t size)
+    {
+        std::size_t start = _cursor;
+
+        for(std::size_t i = 0; i < size; ) {
+            std::size_t end = url_safe_run_end(s, i, size);
+            if(add_bytes(s + i, end - i) < end - i || end == size) break;
+
+            if(!make_room(3)) {
+                _isOverflow = true;
+                break;
+            }
+
+            _buffer[_cursor] = '%';
+            add_hex_pair(&_buffer[_cursor + 1], (unsigned char)s[end]);
+            _cursor += 3;
+            i = end + 1;
+        }
+
+        set_string_end();
+        return _cursor - start;
+    }
+
+    size_t add_url_encoded(const char* s) { return add_url_encoded(s, std::strlen(s)); }
+
+    /** Adds a string escaped for XML/HTML text and attribute values: & < > " ' become entities.
+     *  Clean runs are copied at once, an entity is never cut */
+    size_t add_xml_escaped(const char* s, std::size_t size)
+    {
+        std::size_t start = _cursor;
+
+        for(std::size_t i = 0; i < size; ) {
+            std::size_t end = xml_safe_run_end(s, i, size);
+            if(add_bytes(s + i, end - i) < end - i || end == size) break;
+
+            const char* entity = xml_entity(s[end]);
+            std::size_t length = std::strlen(entity);
+            if(!make_room(length)) {
+                _isOverflow = true;
+                break;
+            }
+
+            std::memcpy(&_buffer[_cursor], entity, length);
+            _cursor += length;
+            i = end + 1;
+        }
+
+        set_string_end();
+        return _cursor - start;
+    }
+
+    size_t add_xml_escaped(const char* s) { return add_xml_escaped(s, std::strlen(s)); }
+
+    /** Adds a classic hex dump, 16 bytes per line with an offset column and ASCII gutter:
+     *  00000010  48 65 6C 6C 6F 20 77 6F  72 6C 64 0A              |Hello world.|
+     *  offset is the first byte address to show. If the output does not fit, only whole lines are added */
+    size_t add_hexdump(const void* data, std::size_t size, uint32_t offset = 0)
+    {
+        const unsigned char* src = (const unsigned char*)data;
+        std::size_t start = _cursor;
+
+        for(std::size_t line = 0; line < size; line += 16, offset += 16) {
+            std::size_t n = size - line < 16 ? size - line : 16;
+            std::size_t length = 63 + n;     /* offset, 2 spaces, hex, 2 spaces, |gutter|, '\n' */
+
+            if(!make_room(length)) {
+                _isOverflow = true;
+                break;
+            }
+
+            char* dest = &_buffer[_cursor];
+            add_hex_pair(dest, (unsigned char)(offset >> 24));
+            add_hex_pair(dest + 2, (unsigned char)(offset >> 16));
+            add_hex_pair(dest + 4, (unsigned char)(offset >> 8));
+            add_hex_pair(dest + 6, (unsigned char)offset);
+            std::memset(dest + 8, ' ', 52);
+
+            char* gutter = dest + 61;
+            dest[60] = '|';
+            for(std::size_t j = 0; j < n; j++) {
+                unsigned char c = src[line + j];
+                add_hex_pair(dest + 10 + j * 3 + (j >= 8), c);
+                gutter[j] = (c >= 0x20 && c < 0x7f) ? (char)c : '.';
+            }
+            gutter[n] = '|';
+            gutter[n + 1] = '\n';
+
+            _cursor += length;
+        }
+
+        set_string_end();
+        return _cursor - start;
+    }
+
+#if TCSB_USE_CHECKSUM
+    /*----------------- CHECKSUM -----------------------*/
+private:
+    static const uint16_t* crc16_table()
+    {
+        static const uint16_t table[256] = {
+            0x0000U, 0x1021U, 0x2042U, 0x3063U, 0x4084U, 0x50A5U, 0x60C6U, 0x70E7U,
+            0x8108U, 0x9129U, 0xA14AU, 0xB16BU, 0xC18CU, 0xD1ADU, 0xE1CEU, 0xF1EFU,
+            0x1231U, 0x0210U, 0x3273U, 0x2252U, 0x52B5U, 0x4294U, 0x72F7U, 0x62D6U,
+            0x9339U, 0x8318U, 0xB37BU, 0xA35AU, 0xD3BDU, 0xC39CU, 0xF3FFU, 0xE3DEU,
+            0x2462U, 0x3443U, 0x0420U, 0x1401U, 0x64E6U, 0x74C7U, 0x44A4U, 0x5485U,
+            0xA56AU, 0xB54BU, 0x8528U, 0x9509U, 0xE5EEU, 0xF5CFU, 0xC5ACU, 0xD58DU,
+            0x3653U, 0x2672U, 0x1611U, 0x0630U, 0x76D7U, 0x66F6U, 0x5695U, 0x46B4U,
+            0xB75BU, 0xA77AU, 0x9719U, 0x8738U, 0xF7DFU, 0xE7FEU, 0xD79DU, 0xC7BCU,
+            0x48C4U, 0x58E5U, 0x6886U, 0x78A7U, 0x0840U, 0x1861U, 0x2802U, 0x3823U,
+            0xC9CCU, 0xD9EDU, 0xE98EU, 0xF9AFU, 0x8948U, 0x9969U, 0xA90AU, 0xB92BU,
+            0x5AF5U, 0x4AD4U, 0x7AB7U, 0x6A96U, 0x1A71U, 0x0A50U, 0x3A33U, 0x2A12U,
+            0xDBFDU, 0xCBDCU, 0xFBBFU, 0xEB9EU, 0x9B79U, 0x8B58U, 0xBB3BU, 0xAB1AU,
+            0x6CA6U, 0x7C87U, 0x4CE4U, 0x5CC5U, 0x2C22U, 0x3C03U, 0x0C60U, 0x1C41U,
+            0xEDAEU, 0xFD8FU, 0xCDECU, 0xDDCDU, 0xAD2AU, 0xBD0BU, 0x8D68U, 0x9D49U,
+            0x7E97U, 0x6EB6U, 0x5ED5U, 0x4EF4U, 0x3E13U, 0x2E32U, 0x1E51U, 0x0E70U,
+            0xFF9FU, 0xEFBEU, 0xDFDDU, 0xCFFCU, 0xBF1BU, 0xAF3AU, 0x9F59U, 0x8F78U,
+            0x9188U, 0x81A9U, 0xB1CAU, 0xA1EBU, 0xD10CU, 0xC12DU, 0xF14EU, 0xE16FU,
+            0x1080U, 0x00A1U, 0x30C2U, 0x20E3U, 0x5004U, 0x4025U, 0x7046U, 0x6067U,
+            0x83B9U, 0x9398U, 0xA3FBU, 0xB3DAU, 0xC33DU, 0xD31CU, 0xE37FU, 0xF35EU,
+            0x02B1U, 0x1290U, 0x22F3U, 0x32D2U, 0x4235U, 0x5214U, 0x6277U, 0x7256U,
+            0xB5EAU, 0xA5CBU, 0x95A8U, 0x8589U, 0xF56EU, 0xE54FU, 0xD52CU, 0xC50DU,
+            0x34E2U, 0x24C3U, 0x14A0U, 0x0481U, 0x7466U, 0x6447U, 0x5424U, 0x4405U,
+            0xA7DBU, 0xB7FAU, 0x8799U, 0x97B8U, 0xE75FU, 0xF77EU, 0xC71DU, 0xD73CU,
+            0x26D3U, 0x36F2U, 0x0691U, 0x16B0U, 0x6657U, 0x7676U, 0x4615U, 0x5634U,
+            0xD94CU, 0xC96DU, 0xF90EU, 0xE92FU, 0x99C8U, 0x89E9U, 0xB98AU, 0xA9ABU,
+            0x5844U, 0x4865U, 0x7806U, 0x6827U, 0x18C0U, 0x08E1U, 0x3882U, 0x28A3U,
+            0xCB7DU, 0xDB5CU, 0xEB3FU, 0xFB1EU, 0x8BF9U, 0x9BD8U, 0xABBBU, 0xBB9AU,
+            0x4A75U, 0x5A54U, 0x6A37U, 0x7A16U, 0x0AF1U, 0x1AD0U, 0x2AB3U, 0x3A92U,
+            0xFD2EU, 0xED0FU, 0xDD6CU, 0xCD4DU, 0xBDAAU, 0xAD8BU, 0x9DE8U, 0x8DC9U,
+            0x7C26U, 0x6C07U, 0x5C64U, 0x4C45U, 0x3CA2U, 0x2C83U, 0x1CE0U, 0x0CC1U,
+            0xEF1FU, 0xFF3EU, 0xCF5DU, 0xDF7CU, 0xAF9BU, 0xBFBAU, 0x8FD9U, 0x9FF8U,
+            0x6E17U, 0x7E36U, 0x4E55U, 0x5E74U, 0x2E93U, 0x3EB2U, 0x0ED1U, 0x1EF0U
+        };
+        return table;
+    }
+
+#if !TCSB_HAS_CRC32C
+    static const uint32_t* crc32c_table()
+    {
+        static const uint32_t table[256] = {
+            0x00000000U, 0xF26B8303U, 0xE13B70F7U, 0x1350F3F4U, 0xC79A971FU, 0x35F1141CU,
+            0x26A1E7E8U, 0xD4CA64EBU, 0x8AD958CFU, 0x78B2DBCCU, 0x6BE22838U, 0x9989AB3BU,
+            0x4D43CFD0U, 0xBF284CD3U, 0xAC78BF27U, 0x5E133C24U, 0x105EC76FU, 0xE235446CU,
+            0xF165B798U, 0x030E349BU, 0xD7C45070U, 0x25AFD373U, 0x36FF2087U, 0xC494A384U,
+            0x9A879FA0U, 0x68EC1CA3U, 0x7BBCEF57U, 0x89D76C54U, 0x5D1D08BFU, 0xAF768BBCU,
+            0xBC267848U, 0x4E4DFB4BU, 0x20BD8EDEU, 0xD2D60DDDU, 0xC186FE29U, 0x33ED7D2AU,
+            0xE72719C1U, 0x154C9AC2U, 0x061C6936U, 0xF477EA35U, 0xAA64D611U, 0x580F5512U,
+            0x4B5FA6E6U, 0xB93425E5U, 0x6DFE410EU, 0x9F95C20DU, 0x8CC531F9U, 0x7EAEB2FAU,
+            0x30E349B1U, 0xC288CAB2U, 0xD1D83946U, 0x23B3BA45U, 0xF779DEAEU, 0x05125DADU,
+            0x1642AE59U, 0xE4292D5AU, 0xBA3A117EU, 0x4851927DU, 0x5B016189U, 0xA96AE28AU,
+            0x7DA08661U, 0x8FCB0562U, 0x9C9BF696U, 0x6EF07595U, 0x417B1DBCU, 0xB3109EBFU,
+            0xA0406D4BU, 0x522BEE48U, 0x86E18AA3U, 0x748A09A0U, 0x67DAFA54U, 0x95B17957U,
+            0xCBA24573U, 0x39C9C670U, 0x2A993584U, 0xD8F2B687U, 0x0C38D26CU, 0xFE53516FU,
+            0xED03A29BU, 0x1F682198U, 0x5125DAD3U, 0xA34E59D0U, 0xB01EAA24U, 0x42752927U,
+            0x96BF4DCCU, 0x64D4CECFU, 0x77843D3BU, 0x85EFBE38U, 0xDBFC821CU, 0x2997011FU,
+            0x3AC7F2EBU, 0xC8AC71E8U, 0x1C661503U, 0xEE0D9600U, 0xFD5D65F4U, 0x0F36E6F7U,
+            0x61C69362U, 0x93AD1061U, 0x80FDE395U, 0x72966096U, 0xA65C047DU, 0x5437877EU,
+            0x4767748AU, 0xB50CF789U, 0xEB1FCBADU, 0x197448AEU, 0x0A24BB5AU, 0xF84F3859U,
+            0x2C855CB2U, 0xDEEEDFB1U, 0xCDBE2C45U, 0x3FD5AF46U, 0x7198540DU, 0x83F3D70EU,
+            0x90A324FAU, 0x62C8A7F9U, 0xB602C312U, 0x44694011U, 0x5739B3E5U, 0xA55230E6U,
+            0xFB410CC2U, 0x092A8FC1U, 0x1A7A7C35U, 0xE811FF36U, 0x3CDB9BDDU, 0xCEB018DEU,
+            0xDDE0EB2AU, 0x2F8B6829U, 0x82F63B78U, 0x709DB87BU, 0x63CD4B8FU, 0x91A6C88CU,
+            0x456CAC67U, 0xB7072F64U, 0xA457DC90U, 0x563C5F93U, 0x082F63B7U, 0xFA44E0B4U,
+            0xE9141340U, 0x1B7F9043U, 0xCFB5F4A8U, 0x3DDE77ABU, 0x2E8E845FU, 0xDCE5075CU,
+            0x92A8FC17U, 0x60C37F14U, 0x73938CE0U, 0x81F80FE3U, 0x55326B08U, 0xA759E80BU,
+            0xB4091BFFU, 0x466298FCU, 0x1871A4D8U, 0xEA1A27DBU, 0xF94AD42FU, 0x0B21572CU,
+            0xDFEB33C7U, 0x2D80B0C4U, 0x3ED04330U, 0xCCBBC033U, 0xA24BB5A6U, 0x502036A5U,
+            0x4370C551U, 0xB11B4652U, 0x65D122B9U, 0x97BAA1BAU, 0x84EA524EU, 0x7681D14DU,
+            0x2892ED69U, 0xDAF96E6AU, 0xC9A99D9EU, 0x3BC21E9DU, 0xEF087A76U, 0x1D63F975U,
+            0x0E330A81U, 0xFC588982U, 0xB21572C9U, 0x407EF1CAU, 0x532E023EU, 0xA145813DU,
+            0x758FE5D6U, 0x87E466D5U, 0x94B49521U, 0x66DF1622U, 0x38CC2A06U, 0xCAA7A905U,
+            0xD9F75AF1U, 0x2B9CD9F2U, 0xFF56BD19U, 0x0D3D3E1AU, 0x1E6DCDEEU, 0xEC064EEDU,
+            0xC38D26C4U, 0x31E6A5C7U, 0x22B65633U, 0xD0DDD530U, 0x0417B1DBU, 0xF67C32D8U,
+            0xE52CC12CU, 0x1747422FU, 0x49547E0BU, 0xBB3FFD08U, 0xA86F0EFCU, 0x5A048DFFU,
+            0x8ECEE914U, 0x7CA56A17U, 0x6FF599E3U, 0x9D9E1AE0U, 0xD3D3E1ABU, 0x21B862A8U,
+            0x32E8915CU, 0xC083125FU, 0x144976B4U, 0xE622F5B7U, 0xF5720643U, 0x07198540U,
+            0x590AB964U, 0xAB613A67U, 0xB831C993U, 0x4A5A4A90U, 0x9E902E7BU, 0x6CFBAD78U,
+            0x7FAB5E8CU, 0x8DC0DD8FU, 0xE330A81AU, 0x115B2B19U, 0x020BD8EDU, 0xF0605BEEU,
+            0x24AA3F05U, 0xD6C1BC06U, 0xC5914FF2U, 0x37FACCF1U, 0x69E9F0D5U, 0x9B8273D6U,
+            0x88D28022U, 0x7AB90321U, 0xAE7367CAU, 0x5C18E4C9U, 0x4F48173DU, 0xBD23943EU,
+            0xF36E6F75U, 0x0105EC76U, 0x12551F82U, 0xE03E9C81U, 0x34F4F86AU, 0xC69F7B69U,
+            0xD5CF889DU, 0x27A40B9EU, 0x79B737BAU, 0x8BDCB4B9U, 0x988C474DU, 0x6AE7C44EU,
+            0xBE2DA0A5U, 0x4C4623A6U, 0x5F16D052U, 0xAD7D5351U
+        };
+        return table;
+    }
+#endif
+
+    static uint32_t crc32c_update(uint32_t crc, const unsigned char* data, std::size_t size)
+    {
+#if TCSB_HAS_CRC32C && defined(__SSE4_2__)
+    #if defined(__x86_64__)
+        for(; size >= 8; size -= 8, data += 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, data, 8);
+            crc = (uint32_t)_mm_crc32_u64(crc, chunk);
+        }
+    #endif
+        for(; size; size--) crc = _mm_crc32_u8(crc, *data++);
+#elif TCSB_HAS_CRC32C
+    #if defined(__aarch64__)
+        for(; size >= 8; size -= 8, data += 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, data, 8);
+            crc = __crc32cd(crc, chunk);
+        }
+    #endif
+        for(; size; size--) crc = __crc32cb(crc, *data++);
+#else
+        const uint32_t* table = crc32c_table();
+        for(; size; size--) crc = table[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+#endif
+        return crc;
+    }
+
+    void update_checksum(const char* text, std::size_t size)
+    {
+        const unsigned char* data = (const unsigned char*)text;
+        uint32_t sum = _checksum;
+
+        switch(_checksumType) {
+            case CHECKSUM_XOR8:
+                for(; size; size--) sum ^= *data++;
+                break;
+            case CHECKSUM_CRC16_CCITT: {
+                const uint16_t* table = crc16_table();
+                for(; size; size--) sum = (table[((sum >> 8) ^ *data++) & 0xFF] ^ (sum << 8)) & 0xFFFF;
+                break;
+            }
+            case CHECKSUM_CRC32C:
+                sum = crc32c_update(sum, data, size);
+                break;
+            default:
+                break;
+        }
+        _checksum = sum;
+    }
+
+public:
+    /** Starts a running checksum over everything added from now on, until checksum_end() */
+    void checksum_begin(ChecksumType type)
+    {
+        _checksumType = type;
+        _checksumRunning = type != CHECKSUM_NONE;
+        _checksum = type == CHECKSUM_CRC16_CCITT ? 0xFFFFU : type == CHECKSUM_CRC32C ? 0xFFFFFFFFU : 0;
+    }
+
+    /** Stops the running checksum and returns its value */
+    uint32_t checksum_end()
+    {
+        _checksumRunning = false;
+        return checksum();
+    }
+
+    /** Checksum of the text added since checksum_begin() (up to checksum_end()) */
+    uint32_t checksum(void) { return _checksumType == CHECKSUM_CRC32C ? ~_checksum : _checksum; }
+
+    /** Stops the running checksum and adds it as upper case hex: 2, 4 or 8 digits for XOR8, CRC-16, CRC-32C.
+     *  NMEA: sb << '$'; sb.checksum_begin(CHECKSUM_XOR8); sb << body; sb.checksum_end(); sb << '*'; sb.add_checksum_hex(); */
+    size_t add_checksum_hex()
+    {
+        unsigned char bytes[4];
+        uint32_t sum = checksum_end();
+        std::size_t size = _checksumType == CHECKSUM_CRC32C ? 4 : _checksumType == CHECKSUM_CRC16_CCITT ? 2 : 1;
+
+        for(std::size_t i = 0; i < size; i++) bytes[i] = (unsigned char)(sum >> ((size - 1 - i) * 8));
+        if(!make_room(size * 2)) {
+            _isOverflow = true;
+            return 0;
+        }
+        return add_hexbytes(bytes, size);
+    }
+#endif //#if TCSB_USE_CHECKSUM
+
 #if TCSB_USE_DADD
     template<class CharConstPtr>
     size_t dadd(CharConstPtr array, std::size_t size, int8_t value) { return add(array, size) + add(value); }
@@ -319,10 +1176,11 @@ private:
     #define TCSB_expmax     -32
     #define TCSB_expmin     -60
 
-    static const TCSB_Fp& powers_ten(uint_fast8_t index)
+#if !TCSB_FP_COMPACT_POWERS
+    static TCSB_Fp powers_ten(uint_fast8_t index)
     {
         //https://stackoverflow.com/a/15961043/548894
-        static const TCSB_Fp powers_ten[] = {
+        static const TCSB_Fp powers_ten[] TCSB_FP_TABLE_ATTR = {
             { 18054884314459144840U, -1220 },{ 13451937075301367670U, -1193 },
             { 10022474136428063862U, -1166 },{ 14934650266808366570U, -1140 },
             { 11127181549972568877U, -1113 },{ 16580792590934885855U, -1087 },
@@ -371,17 +1229,73 @@ private:
         return powers_ten[index];
     }
 
-    
+    static int powers_ten_exp(uint_fast8_t index) { return powers_ten(index).exp; }
 
-    static TCSB_Fp find_cachedpow10(int exp, int* k)
+#else
+    /* binary exponent of the normalized 10^k, k = TCSB_firstpower + index * TCSB_steppowers
+     * floor(k * log2(10)) - 63, exact for |k| < 1500 */
+    static int powers_ten_exp(uint_fast8_t index)
+    {
+        int k = TCSB_firstpower + index * TCSB_steppowers;
+        return ((k * 1741647) >> 19) - 63;
+    }
+
+    static TCSB_Fp powers_ten(uint_fast8_t index)
+    {
+        /* every 4th entry of the full table: 10^-348, 10^-316, ... 10^324 */
+        static const uint64_t base_powers[] TCSB_FP_TABLE_ATTR = {
+            18054884314459144840U, 11127181549972568877U, 13715310171984221708U, 16905424996341287883U,
+            10418772551374772303U, 12842128665889583758U, 15829145694278690180U, 9755464219737475723U,
+            12024538023802026127U, 14821387422376473014U, 18268770466636286478U, 11258999068426240000U,
+            13877787807814456755U, 17105694144590052135U, 10542197943230523224U, 12994262207056124023U,
+            16016664761464807395U, 9871031767461413346U,  12166986024289022870U, 14996968138956309548U,
+            9242595204427927429U,  11392378155556871081U
+        };
+
+        /* exact 10^8, 10^16, 10^24 */
+        static const TCSB_Fp step_powers[] TCSB_FP_TABLE_ATTR = {
+            { 13743895347200000000U, -37 }, { 10240000000000000000U, -10 }, { 15258789062500000000U, 16 }
+        };
+
+        /* bit masks of entries where the reconstruction is 1 below (up) or 1 above (down) the full table */
+        static const uint32_t correct_up[3] TCSB_FP_TABLE_ATTR   = { 0x20088480U, 0x08000000U, 0x006E4060U };
+        static const uint32_t correct_down[3] TCSB_FP_TABLE_ATTR = { 0xC0020020U, 0x40000004U, 0x00000000U };
+
+        TCSB_Fp fp = { base_powers[index >> 2], powers_ten_exp(index & ~3) };
+
+        if(index & 3) {
+            TCSB_Fp step = step_powers[(index & 3) - 1];
+            fp = multiply(&fp, &step);
+            if(!(fp.frac & TCSB_signmask)) fp.frac <<= 1;
+            fp.exp = powers_ten_exp(index);
+
+            uint32_t bit = 1U << (index & 31);
+            if(correct_up[index >> 5] & bit) fp.frac++;
+            if(correct_down[index >> 5] & bit) fp.frac--;
+        }
+
+        return fp;
+    }
+#endif //#if !TCSB_FP_COMPACT_POWERS
+
+    /* first guess of the cached power index, branch free so it vectorizes over a block of values */
+    static inline int cachedpow10_approx(int exp)
     {
         const double one_log_ten = 0.30102999566398114;
 
         int approx = -(exp + TCSB_npowers) * one_log_ten;
-        int idx = (approx - TCSB_firstpower) / TCSB_steppowers;
+        return (approx - TCSB_firstpower) / TCSB_steppowers;
+    }
+
+    static TCSB_Fp find_cachedpow10(int exp, int* k)
+    {
+        return find_cachedpow10(exp, k, cachedpow10_approx(exp));
+    }
 
+    static TCSB_Fp find_cachedpow10(int exp, int* k, int idx)
+    {
         while(1) {
-            int current = exp + powers_ten(idx).exp + 64;
+            int current = exp + powers_ten_exp(idx) + 64;
 
             if(current < TCSB_expmin) {
                 idx++;
@@ -400,7 +1314,7 @@ private:
     }
     static const uint64_t* tens()
     {
-        static const uint64_t tens[TCSB_tens_len] = {
+        static const uint64_t tens[TCSB_tens_len] TCSB_FP_TABLE_ATTR = {
             10000000000000000000U, 1000000000000000000U, 100000000000000000U,
             10000000000000000U, 1000000000000000U, 100000000000000U,
             10000000000000U, 1000000000000U, 100000000000U,
@@ -423,6 +1337,16 @@ private:
         return dbl_bits.i;
     }
 
+    static inline uint32_t get_fbits(float f)
+    {
+        union {
+            float    flt;
+            uint32_t i;
+        } flt_bits = { f };
+
+        return flt_bits.i;
+    }
+
     TCSB_Fp build_fp(double d)
     {
         uint64_t bits = get_dbits(d);
@@ -442,14 +1366,32 @@ private:
         return fp;
     }
 
+#if TCSB_HAS_CLZ
+    /** count leading zeros, x must not be 0 */
+    static inline int clz64(uint64_t x)
+    {
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(x);
+    #else
+        unsigned long index;
+        _BitScanReverse64(&index, x);
+        return 63 - (int)index;
+    #endif
+    }
+#endif
+
     void normalize(TCSB_Fp* fp)
     {
+#if TCSB_HAS_CLZ
+        int shift = clz64(fp->frac);
+#else
         while ((fp->frac & TCSB_hiddenbit) == 0) {
             fp->frac <<= 1;
             fp->exp--;
         }
 
         int shift = 64 - 52 - 1;
+#endif
         fp->frac <<= shift;
         fp->exp -= shift;
     }
@@ -459,12 +1401,16 @@ private:
         upper->frac = (fp->frac << 1) + 1;
         upper->exp  = fp->exp - 1;
 
+#if TCSB_HAS_CLZ
+        int u_shift = clz64(upper->frac);
+#else
         while ((upper->frac & (TCSB_hiddenbit << 1)) == 0) {
             upper->frac <<= 1;
             upper->exp--;
         }
 
         int u_shift = 64 - 52 - 2;
+#endif
 
         upper->frac <<= u_shift;
         upper->exp = upper->exp - u_shift;
@@ -480,8 +1426,30 @@ private:
         lower->exp = upper->exp;
     }
 
-    TCSB_Fp multiply(TCSB_Fp* a, TCSB_Fp* b)
+    /* 64x64 -> upper 64 bits of the product, rounded half up */
+    static TCSB_Fp multiply(TCSB_Fp* a, TCSB_Fp* b)
     {
+#if TCSB_HAS_UINT128
+        __extension__ typedef unsigned __int128 uint128_t;
+        uint128_t p = (uint128_t)a->frac * b->frac;
+        uint64_t hi = (uint64_t)(p >> 64);
+        uint64_t lo = (uint64_t)p;
+#elif TCSB_HAS_UMUL128
+        uint64_t hi;
+        uint64_t lo = _umul128(a->frac, b->frac, &hi);
+#elif TCSB_HAS_UMULH
+        uint64_t hi = __umulh(a->frac, b->frac);
+        uint64_t lo = a->frac * b->frac;
+#endif
+
+#if TCSB_HAS_UINT128 || TCSB_HAS_UMUL128 || TCSB_HAS_UMULH
+        TCSB_Fp fp = {
+                hi + (lo >> 63),    /* round up */
+                a->exp + b->exp + 64
+        };
+
+        return fp;
+#else
         const uint64_t lomask = 0x00000000FFFFFFFF;
 
         uint64_t ah_bl = (a->frac >> 32)    * (b->frac & lomask);
@@ -499,6 +1467,7 @@ private:
         };
 
         return fp;
+#endif
     }
 
     void round_digit(char* digits, int ndigits, uint64_t delta, uint64_t rem, uint64_t kappa, uint64_t frac)
@@ -572,7 +1541,8 @@ private:
         }
     }
 
-    int grisu2(double d, char* digits, int* K)
+    /* idx is the cached power index guess from cachedpow10_approx, -1 to compute it here */
+    int grisu2(double d, char* digits, int* K, int idx = -1)
     {
         TCSB_Fp w = build_fp(d);
 
@@ -582,7 +1552,7 @@ private:
         normalize(&w);
 
         int k;
-        TCSB_Fp cp = find_cachedpow10(upper.exp, &k);
+        TCSB_Fp cp = idx < 0 ? find_cachedpow10(upper.exp, &k) : find_cachedpow10(upper.exp, &k, idx);
 
         w     = multiply(&w,     &cp);
         upper = multiply(&upper, &cp);
@@ -634,19 +1604,32 @@ private:
         /* write decimal w/ scientific notation */
         ndigits = TCSB_minv(ndigits, 18 - neg);
 
-        int idx = 0;
-        dest[idx++] = digits[0];
+        int idx = emit_mantissa(digits, ndigits, 1, dest);
+        return idx + emit_exponent(K + ndigits - 1, dest + idx);
+    }
 
-        if(ndigits > 1) {
-            dest[idx++] = '.';
-            std::memcpy(dest + idx, digits + 1, ndigits - 1);
-            idx += ndigits - 1;
+    /* writes digits with int_digits digits before the decimal point, pads with zeros if needed */
+    int emit_mantissa(char* digits, int ndigits, int int_digits, char* dest)
+    {
+        if(ndigits <= int_digits) {
+            std::memcpy(dest, digits, ndigits);
+            std::memset(dest + ndigits, '0', int_digits - ndigits);
+            return int_digits;
         }
 
-        dest[idx++] = 'e';
+        std::memcpy(dest, digits, int_digits);
+        dest[int_digits] = '.';
+        std::memcpy(dest + int_digits + 1, digits + int_digits, ndigits - int_digits);
+        return ndigits + 1;
+    }
 
-        char sign = K + ndigits - 1 < 0 ? '-' : '+';
-        dest[idx++] = sign;
+    /* writes e+NN / e-NN */
+    int emit_exponent(int exp, char* dest)
+    {
+        int idx = 0;
+        dest[idx++] = 'e';
+        dest[idx++] = exp < 0 ? '-' : '+';
+        exp = TCDB_absv(exp);
 
         int cent = 0;
 
@@ -669,6 +1652,27 @@ private:
         return idx;
     }
 
+    /* scientific, engineering and SI prefix forms of the same shortest digits */
+    int emit_notation(char* digits, int ndigits, char* dest, int K, FpNotation notation)
+    {
+        int exp = K + ndigits - 1;      /* decimal exponent of the first digit */
+        int shown = exp;
+
+        if(notation != FP_SCIENTIFIC) {
+            shown = exp >= 0 ? exp / 3 * 3 : -((2 - exp) / 3 * 3);
+        }
+
+        int idx = emit_mantissa(digits, ndigits, exp - shown + 1, dest);
+
+        if(notation == FP_SI && shown >= -24 && shown <= 24) {
+            static const char si_prefixes[] TCSB_FP_TABLE_ATTR = "yzafpnum kMGTPEZY";
+            if(shown) dest[idx++] = si_prefixes[shown / 3 + 8];
+            return idx;
+        }
+
+        return idx + emit_exponent(shown, dest + idx);
+    }
+
     int filter_special(double fp, char* dest)
     {
         if(fp == 0.0) {
@@ -693,7 +1697,7 @@ private:
         return 3;
     }
 
-    size_t fpconv_dtoa(double d, char dest[24])
+    size_t fpconv_dtoa(double d, char dest[FP_MAX_LENGTH], FpNotation notation, int idx = -1)
     {
         char digits[18];
 
@@ -713,29 +1717,197 @@ private:
         }
 
         int K = 0;
-        int ndigits = grisu2(d, digits, &K);
+        int ndigits = grisu2(d, digits, &K, idx);
 
-        str_len += emit_digits(digits, ndigits, dest + str_len, K, neg);
+        if(notation == FP_AUTO) {
+            str_len += emit_digits(digits, ndigits, dest + str_len, K, neg);
+        } else {
+            str_len += emit_notation(digits, ndigits, dest + str_len, K, notation);
+        }
 
         return str_len;
     }
 
-public:
+    /* C99 %a layout: [-]0xL.hhhp+d, mant holds 52 bits after the leading digit L, trailing zeros are omitted */
+    size_t emit_hexfloat(bool neg, int lead, uint64_t mant, int exp, char* dest)
+    {
+        static const char hex_digits[] TCSB_FP_TABLE_ATTR = "0123456789abcdef";
+        size_t idx = 0;
+
+        if(neg) dest[idx++] = '-';
+        dest[idx++] = '0';
+        dest[idx++] = 'x';
+        dest[idx++] = (char)('0' + lead);
+
+        if(mant) {
+            dest[idx++] = '.';
+            for(int shift = 48; mant; shift -= 4) {
+                dest[idx++] = hex_digits[(mant >> shift) & 0xF];
+                mant &= (1ULL << shift) - 1;
+            }
+        }
 
-    size_t addf(double value)
+        dest[idx++] = 'p';
+        dest[idx++] = exp < 0 ? '-' : '+';
+        exp = TCDB_absv(exp);
+
+        /* 1..4 decimal digits */
+        char exp_digits[4];
+        int ndigits = 0;
+        do {
+            exp_digits[ndigits++] = (char)('0' + exp % 10);
+            exp /= 10;
+        } while(exp);
+
+        while(ndigits) dest[idx++] = exp_digits[--ndigits];
+
+        return idx;
+    }
+
+    size_t fpconv_htoa(double d, char dest[24])
+    {
+        uint64_t bits = get_dbits(d);
+        bool neg = (bits & TCSB_signmask) != 0;
+        int exp = (int)((bits & TCSB_expmask) >> 52);
+        uint64_t mant = bits & TCSB_fracmask;
+
+        if(exp == 0x7FF) {
+            if(neg) dest[0] = '-';
+            return neg + filter_special(d, dest + neg);
+        }
+
+        if(!exp) {
+            /* zero and subnormals are printed as 0x0.hhhp-1022 as printf does */
+            return emit_hexfloat(neg, 0, mant, mant ? -1022 : 0, dest);
+        }
+
+        return emit_hexfloat(neg, 1, mant, exp - 1023, dest);
+    }
+
+    size_t fpconv_htoa(float f, char dest[24])
+    {
+        uint32_t bits = get_fbits(f);
+        bool neg = (bits & 0x80000000U) != 0;
+        int exp = (int)((bits >> 23) & 0xFF);
+        uint32_t mant = bits & 0x007FFFFFU;
+
+        if(exp == 0xFF) {
+            if(neg) dest[0] = '-';
+            return neg + filter_special(f, dest + neg);
+        }
+
+        if(!exp) {
+            if(!mant) return emit_hexfloat(neg, 0, 0, 0, dest);
+
+            /* float subnormals are normal as double, which is what printf("%a", f) shows */
+            exp = 1;
+            while(!(mant & 0x00800000U)) {
+                mant <<= 1;
+                exp--;
+            }
+            mant &= 0x007FFFFFU;
+        }
+
+        return emit_hexfloat(neg, 1, (uint64_t)mant << 29, exp - 127, dest);
+    }
+
+    /* adds up to FP_MAX_LENGTH chars written by format(dest), a streaming builder formats them aside
+     * near the end of the buffer so a number is never split */
+    template <typename Format>
+    size_t add_fp(Format format)
     {
-        // TODO now buffer have to have at least 24 bytes left while in most of the cases it should be less
-        if(_bufferSize - _cursor < 24) {
+        // TODO now buffer have to have at least FP_MAX_LENGTH bytes left while in most of the cases it should be less
+        if(write_limit() - _cursor < FP_MAX_LENGTH + 1) {     // + 1 for '\0'
+            if(_flushHook) {
+                char digits[FP_MAX_LENGTH];
+                size_t size = format(digits);
+                if(make_room(size)) return add_bytes(digits, size);
+            }
             _isOverflow = true;
             return 0;
         }
 
-        size_t size = fpconv_dtoa(value, &_buffer[_cursor]);
+        size_t size = format(&_buffer[_cursor]);
         _cursor += size;
         set_string_end();
         return size;
     }
 
+public:
+
+    /** Sets notation used by addf(double) and operator<< for doubles */
+    void fp_notation(FpNotation notation) { _fpNotation = notation; }
+
+    /** Current floating point notation */
+    FpNotation fp_notation(void) { return _fpNotation; }
+
+    size_t addf(double value) { return addf(value, _fpNotation); }
+
+    /** Converts double to string using given notation and adds to the buffer */
+    size_t addf(double value, FpNotation notation)
+    {
+        return add_fp([&](char* dest) { return fpconv_dtoa(value, dest, notation); });
+    }
+
+    /** Adds n doubles separated by sep, returns the number of chars added.
+     *  Values are taken in blocks of 8: specials are classified and cached powers are picked for the whole
+     *  block at once and the buffer is checked once per block */
+    size_t addf_array(const double* values, std::size_t n, char sep)
+    {
+        const std::size_t block = 8;
+        const std::size_t max_len = FP_MAX_LENGTH + 1;     /* fpconv_dtoa + separator */
+        std::size_t start = _cursor;
+        int idx[block];
+
+        for(std::size_t i = 0; i < n; i += block) {
+            std::size_t count = TCSB_minv(block, n - i);
+
+            if(write_limit() - _cursor < count * max_len + 1) {
+                /* the block may not fit, add values one by one until the buffer is full,
+                 * a separator is only added together with a value that fits after it */
+                for(std::size_t j = i; j < n; j++) {
+                    if(j) {
+                        if(!_flushHook && write_limit() - _cursor < 1 + FP_MAX_LENGTH + 1) {
+                            _isOverflow = true;
+                            break;
+                        }
+                        add(sep);
+                    }
+                    if(!addf(values[j])) break;
+                }
+                break;
+            }
+
+            for(std::size_t j = 0; j < count; j++) {
+                int exp = (int)((get_dbits(values[i + j]) & TCSB_expmask) >> 52);
+                bool normal = exp != 0 && exp != 0x7FF;
+
+                /* upper boundary of a normal double is normalized by a constant shift */
+                idx[j] = normal ? cachedpow10_approx(exp - TCSB_expbias - 11) : -1;
+            }
+
+            for(std::size_t j = 0; j < count; j++) {
+                if(i + j) _buffer[_cursor++] = sep;
+                _cursor += fpconv_dtoa(values[i + j], &_buffer[_cursor], _fpNotation, idx[j]);
+            }
+        }
+
+        set_string_end();
+        return _cursor - start;
+    }
+
+    /** Adds exact hexadecimal representation of double as printf("%a") does: 0x1.8p+1 */
+    size_t addf_hex(double value)
+    {
+        return add_fp([&](char* dest) { return fpconv_htoa(value, dest); });
+    }
+
+    /** Adds exact hexadecimal representation of float as printf("%a") does: 0x1.99999ap-4 */
+    size_t addf_hex(float value)
+    {
+        return add_fp([&](char* dest) { return fpconv_htoa(value, dest); });
+    }
+
 #if TCSB_USE_DADD
     template<class CharConstPtr>
     size_t daddf(CharConstPtr array, std::size_t size, double value) { return add(array, size) + addf(value); }
@@ -754,8 +1926,8 @@ public:
     template <typename IntType>
     size_t addIntValue(IntType n)
     {
-        if(_cursor!=0) return addSeparator() + IntTypeToS(n);   // add separator (' ') by def. if not the first line
-        return IntTypeToS(n);
+        if(_cursor!=0) return addSeparator() + add_integer(n);   // add separator (' ') by def. if not the first line
+        return add_integer(n);
     }
 
 
@@ -783,28 +1955,28 @@ public:
 
 
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], int8_t value  )  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<int8_t>(value)   ; }   /// Converts int8_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<int8_t>(value)   ; }   /// Converts int8_t to string and adds to the buffer
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], uint8_t value )  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<uint8_t>(value)  ; }   /// Converts uint8_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<uint8_t>(value)  ; }   /// Converts uint8_t to string and adds to the buffer
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], int16_t value )  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<int16_t>(value)  ; }   /// Converts int16_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<int16_t>(value)  ; }   /// Converts int16_t to string and adds to the buffer
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], uint16_t value)  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<uint16_t>(value) ; }   /// Converts uint16_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<uint16_t>(value) ; }   /// Converts uint16_t to string and adds to the buffer
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], int32_t value )  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<int32_t>(value)  ; }   /// Converts int32_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<int32_t>(value)  ; }   /// Converts int32_t to string and adds to the buffer
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], uint32_t value)  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<uint32_t>(value) ; }   /// Converts uint32_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<uint32_t>(value) ; }   /// Converts uint32_t to string and adds to the buffer
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], int64_t value )  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<int64_t>(value)  ; }   /// Converts int64_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<int64_t>(value)  ; }   /// Converts int64_t to string and adds to the buffer
     template <std::size_t SIZE> size_t addValue(const char (&array)[SIZE], uint64_t value)  { return
-                sadd(array, SIZE) + addSeparator() + IntTypeToS<uint64_t>(value) ; }   /// Converts uint64_t to string and adds to the buffer
+                sadd(array, SIZE) + addSeparator() + add_integer<uint64_t>(value) ; }   /// Converts uint64_t to string and adds to the buffer
 
     size_t addSeparator(char sepCh)
     {
-        if(_bufferSize - 1 == _cursor) return 0;
+        if(write_limit() - 1 == _cursor) return 0;
         _buffer[_cursor] = (char)sepCh;
         _cursor++;
-        setStringEnd();
+        set_string_end();
         return 1;
     }
 
@@ -0,0 +1,721 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_CSTRINGPARSER_HPP
+#define HEADERLOCK_CSTRINGPARSER_HPP
+
+#include "CStringBuilder.hpp"
+
+// Float parsing falls back to exact decimal arithmetic for inputs the fast path can not round correctly.
+// Its digit buffer lives on the stack of parsef only. Longer inputs are still rounded correctly.
+// The fallback takes about TCSB_PARSE_DECIMAL_DIGITS + 20 bytes of stack (820 by default), also when
+// reached through CStringTokenizer::nextf. A lower value saves stack but near-halfway inputs may then
+// be off by one in the last bit, 800 is what exact rounding of every double needs
+#if !defined( TCSB_PARSE_DECIMAL_DIGITS )
+    #define TCSB_PARSE_DECIMAL_DIGITS (800)
+#endif
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Parses numbers back from a C string, the counterpart of CStringBuilder.
+ *  Each parse call returns the number of chars consumed and advances the cursor,
+ *  or returns 0 and leaves both the cursor and the value untouched */
+class CStringParser {
+    CStringParser(const CStringParser&) = delete;
+    CStringParser& operator=(const CStringParser&) = delete;
+
+private:
+    const char* _buffer;
+    std::size_t _bufferSize;
+    std::size_t _cursor;
+
+#if TCSB_HAS_SWAR
+    /* high bit is set in every byte of chunk that is not '0'..'9' */
+    static inline uint64_t non_digits(uint64_t chunk)
+    {
+        uint64_t low7 = chunk & ~TCSB_swar_highs;
+        uint64_t below = ~((low7 | TCSB_swar_highs) - TCSB_swar_ones * '0');     /* < '0' */
+        uint64_t above = low7 + TCSB_swar_ones * (0x80 - '9' - 1);              /* > '9' */
+        return (below | above | chunk) & TCSB_swar_highs;
+    }
+
+    /* value of 8 ASCII digits, the first char is the lowest byte */
+    static inline uint64_t eight_digits(uint64_t chunk)
+    {
+        chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+        chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+        return ((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+    }
+#endif
+
+    /* reads decimal digits, returns their count. Sets overflow if the value does not fit into uint64_t */
+    static std::size_t read_digits(const char* s, std::size_t avail, uint64_t& value, bool& overflow)
+    {
+        std::size_t i = 0;
+        value = 0;
+        overflow = false;
+
+#if TCSB_HAS_SWAR
+        /* 8 digits at a time while value * 10^8 + 99999999 can not overflow */
+        while(avail - i >= 8 && value < 100000000000ULL) {
+            uint64_t chunk = TCSB_Swar::load(s + i);
+            uint64_t mask = non_digits(chunk);
+            if(!mask) {
+                value = value * 100000000 + eight_digits(chunk);
+                i += 8;
+                continue;
+            }
+
+            /* the number ends inside the chunk: shift its n digits up, lower bytes count as leading zeros */
+            int n = TCSB_Swar::first(mask);
+            if(n) {
+                static const uint32_t pow10[8] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+                value = value * pow10[n] + eight_digits(chunk << (64 - 8 * n));
+                i += n;
+            }
+            return i;
+        }
+#endif
+
+        for(; i < avail; i++) {
+            unsigned digit = (unsigned char)s[i] - '0';
+            if(digit > 9) break;
+
+            if(value > 1844674407370955161ULL || (value == 1844674407370955161ULL && digit > 5)) {
+                overflow = true;
+            }
+            value = value * 10 + digit;
+        }
+
+        return i;
+    }
+
+#if TCSB_USE_FP
+    /* Fast path: w * 10^q with the cached 64-bit powers of CStringBuilder. 10^q = 10^r * cached 10^(q - r),
+     * each multiply is rounded, so the 64-bit result is off by at most a few units. When its lower 11 bits are
+     * too close to the rounding point the result is undecided and false is returned */
+    static bool fast_decimal_to_bits(uint64_t w, int q, uint64_t& bits)
+    {
+        static const TCSB_Fp small_powers[8] TCSB_FP_TABLE_ATTR = {
+            { 9223372036854775808U, -63 }, { 11529215046068469760U, -60 }, { 14411518807585587200U, -57 },
+            { 18014398509481984000U, -54 }, { 11258999068426240000U, -50 }, { 14073748835532800000U, -47 },
+            { 17592186044416000000U, -44 }, { 10995116277760000000U, -40 }
+        };
+        const uint64_t error = 8;
+
+        /* w < 10^19: below 10^-324 rounds to zero, above 10^308 to infinity */
+        if(!w || q < -343) {
+            bits = 0;
+            return true;
+        }
+        if(q > 308) {
+            bits = TCSB_expmask;
+            return true;
+        }
+
+        int idx = (q - TCSB_firstpower) / TCSB_steppowers;
+        int r = q - (TCSB_firstpower + idx * TCSB_steppowers);
+
+        TCSB_Fp x = { w, 0 };
+        while(!(x.frac & TCSB_signmask)) {
+            x.frac <<= 1;
+            x.exp--;
+        }
+
+        if(r) {
+            TCSB_Fp step = small_powers[r];
+            x = CStringBuilder::multiply(&x, &step);
+            if(!(x.frac & TCSB_signmask)) {
+                x.frac <<= 1;
+                x.exp--;
+            }
+        }
+
+        TCSB_Fp cp = CStringBuilder::powers_ten(idx);
+        x = CStringBuilder::multiply(&x, &cp);
+        if(!(x.frac & TCSB_signmask)) {
+            x.frac <<= 1;
+            x.exp--;
+        }
+
+        uint64_t low = x.frac & 0x7FF;
+        if(low > 0x400 - error && low < 0x400 + error) return false;
+
+        uint64_t mant = (x.frac >> 11) + ((x.frac >> 10) & 1);
+        int exp = x.exp + 11 + 52 + 1023;   /* biased exponent of mant * 2^(x.exp + 11) */
+
+        if(mant == (TCSB_hiddenbit << 1)) {
+            mant >>= 1;
+            exp++;
+        }
+
+        if(exp <= 0) return false;          /* subnormals are left to the exact path */
+
+        if(exp >= 0x7FF) {
+            bits = TCSB_expmask;
+            return true;
+        }
+
+        bits = (mant & TCSB_fracmask) | ((uint64_t)exp << 52);
+        return true;
+    }
+
+    /* Exact path: decimal digits shifted by powers of two until the mantissa is an integer.
+     * The algorithm is the one of Go strconv (decimal.go) */
+    struct Decimal {
+        char d[TCSB_PARSE_DECIMAL_DIGITS + 20];     /* + room for the digits one left shift adds */
+        int nd;                                     /* number of digits used */
+        int dp;                                     /* decimal point: value is 0.d[0..nd) * 10^dp */
+        bool trunc;                                 /* nonzero digits were dropped */
+    };
+
+    static void decimal_trim(Decimal& a)
+    {
+        while(a.nd > 0 && a.d[a.nd - 1] == '0') a.nd--;
+        if(a.nd == 0) a.dp = 0;
+    }
+
+    /* multiply by 2^k, k <= 60 */
+    static void decimal_left_shift(Decimal& a, unsigned k)
+    {
+        int delta = (int)((k * 1233) >> 12) + 1;    /* digits of 2^k: at most that many digits are added */
+        int w = a.nd + delta;
+        uint64_t n = 0;
+
+        for(int r = a.nd - 1; r >= 0; r--) {
+            n += (uint64_t)(a.d[r] - '0') << k;
+            uint64_t quo = n / 10;
+            a.d[--w] = (char)('0' + (n - 10 * quo));
+            n = quo;
+        }
+
+        while(n > 0) {
+            uint64_t quo = n / 10;
+            a.d[--w] = (char)('0' + (n - 10 * quo));
+            n = quo;
+        }
+
+        /* fewer digits than delta were added: move them to the front */
+        delta -= w;
+        if(w) std::memmove(a.d, a.d + w, a.nd + delta);
+
+        a.nd += delta;
+        a.dp += delta;
+
+        for(; a.nd > TCSB_PARSE_DECIMAL_DIGITS; a.nd--) {
+            if(a.d[a.nd - 1] != '0') a.trunc = true;
+        }
+
+        decimal_trim(a);
+    }
+
+    /* divide by 2^k, k <= 60 */
+    static void decimal_right_shift(Decimal& a, unsigned k)
+    {
+        int r = 0;
+        int w = 0;
+        uint64_t n = 0;
+
+        for(; (n >> k) == 0; r++) {
+            if(r >= a.nd) {
+                if(n == 0) {
+                    a.nd = 0;
+                    return;
+                }
+                while((n >> k) == 0) {
+                    n *= 10;
+                    r++;
+                }
+                break;
+            }
+            n = n * 10 + (uint64_t)(a.d[r] - '0');
+        }
+
+        a.dp -= r - 1;
+
+        uint64_t mask = ((uint64_t)1 << k) - 1;
+        for(; r < a.nd; r++) {
+            uint64_t digit = n >> k;
+            n &= mask;
+            a.d[w++] = (char)('0' + digit);
+            n = n * 10 + (uint64_t)(a.d[r] - '0');
+        }
+
+        while(n > 0) {
+            uint64_t digit = n >> k;
+            n &= mask;
+            if(w < TCSB_PARSE_DECIMAL_DIGITS) {
+                a.d[w++] = (char)('0' + digit);
+            } else if(digit > 0) {
+                a.trunc = true;
+            }
+            n *= 10;
+        }
+
+        a.nd = w;
+        decimal_trim(a);
+    }
+
+    static void decimal_shift(Decimal& a, int k)
+    {
+        if(a.nd == 0) return;
+
+        for(; k > 60; k -= 60) decimal_left_shift(a, 60);
+        for(; k < -60; k += 60) decimal_right_shift(a, 60);
+
+        if(k > 0) decimal_left_shift(a, (unsigned)k);
+        if(k < 0) decimal_right_shift(a, (unsigned)-k);
+    }
+
+    /* integer part rounded half to even */
+    static uint64_t decimal_rounded_integer(Decimal& a)
+    {
+        int i;
+        uint64_t n = 0;
+
+        for(i = 0; i < a.dp && i < a.nd; i++) n = n * 10 + (uint64_t)(a.d[i] - '0');
+        for(; i < a.dp; i++) n *= 10;
+
+        if(a.dp >= 0 && a.dp < a.nd) {
+            bool halfway = a.d[a.dp] == '5' && a.dp + 1 == a.nd;
+            if(halfway ? a.trunc || (a.dp > 0 && (a.d[a.dp - 1] - '0') % 2 == 1) : a.d[a.dp] >= '5') n++;
+        }
+
+        return n;
+    }
+
+    static uint64_t decimal_to_bits(Decimal& a)
+    {
+        static const int shifts[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };     /* 2^shifts[i] <= 10^i */
+        const int bias = -1023;
+
+        if(a.nd == 0 || a.dp < -330) return 0;
+        if(a.dp > 310) return TCSB_expmask;
+
+        int exp = 0;
+
+        /* scale to [0.5, 1) */
+        while(a.dp > 0) {
+            int n = a.dp >= 9 ? 27 : shifts[a.dp];
+            decimal_shift(a, -n);
+            exp += n;
+        }
+        while(a.dp < 0 || (a.dp == 0 && a.d[0] < '5')) {
+            int n = -a.dp >= 9 ? 27 : shifts[-a.dp];
+            decimal_shift(a, n);
+            exp -= n;
+        }
+
+        /* [1, 2) */
+        exp--;
+
+        /* subnormal */
+        if(exp < bias + 1) {
+            int n = bias + 1 - exp;
+            decimal_shift(a, -n);
+            exp += n;
+        }
+
+        if(exp - bias >= 0x7FF) return TCSB_expmask;
+
+        decimal_shift(a, 1 + 52);
+        uint64_t mant = decimal_rounded_integer(a);
+
+        if(mant == (TCSB_hiddenbit << 1)) {
+            mant >>= 1;
+            exp++;
+            if(exp - bias >= 0x7FF) return TCSB_expmask;
+        }
+
+        if(!(mant & TCSB_hiddenbit)) exp = bias;
+
+        return (mant & TCSB_fracmask) | ((uint64_t)((exp - bias) & 0x7FF) << 52);
+    }
+
+    /* digits with an optional '.' in s[0..len), exponent exp */
+    static uint64_t slow_decimal_to_bits(const char* s, std::size_t len, int exp)
+    {
+        Decimal a;
+        a.nd = 0;
+        a.dp = 0;
+        a.trunc = false;
+        bool sawdot = false;
+
+        for(std::size_t i = 0; i < len; i++) {
+            char c = s[i];
+            if(c == '.') {
+                sawdot = true;
+                a.dp = a.nd;
+                continue;
+            }
+            if(c == '0' && a.nd == 0) {     /* leading zeros */
+                a.dp--;
+                continue;
+            }
+            if(a.nd < TCSB_PARSE_DECIMAL_DIGITS) {
+                a.d[a.nd++] = c;
+            } else if(c != '0') {
+                a.trunc = true;
+            }
+        }
+
+        if(!sawdot) a.dp = a.nd;
+        a.dp += exp;
+
+        return decimal_to_bits(a);
+    }
+
+    static double bits_to_double(uint64_t bits)
+    {
+        union {
+            uint64_t i;
+            double   dbl;
+        } dbl_bits = { bits };
+
+        return dbl_bits.dbl;
+    }
+#endif //#if TCSB_USE_FP
+
+public:
+    /** Parser over the first bufferSize chars of buffer. Parsing also stops at '\0' */
+    CStringParser(const char *buffer, std::size_t bufferSize) {
+        _buffer = buffer;
+        _bufferSize = bufferSize;
+        _cursor = 0;
+    }
+
+    /** Parser over a C string, its length is taken with strlen */
+    explicit CStringParser(const char *str) {
+        _buffer = str;
+        _bufferSize = std::strlen(str);
+        _cursor = 0;
+    }
+
+    /** Parses [+-]digits into any of int8_t .. uint64_t, fails on no digits and on overflow */
+    template <typename IntType>
+    size_t parse_integer(IntType& result)
+    {
+        const char* s = &_buffer[_cursor];
+        std::size_t avail = remaining();
+        std::size_t i = 0;
+        bool isNegative = false;
+
+        if(i < avail && (s[i] == '-' || s[i] == '+')) {
+            isNegative = s[i] == '-';
+            if(isNegative && !std::is_signed<IntType>::value) return 0;
+            i++;
+        }
+
+        uint64_t value;
+        bool overflow;
+        std::size_t ndigits = read_digits(s + i, avail - i, value, overflow);
+        if(!ndigits || overflow) return 0;
+
+        /* max magnitude: 2^(bits-1) for negative, 2^(bits-1)-1 for positive signed, 2^bits-1 for unsigned */
+        const uint64_t max = std::is_signed<IntType>::value
+                ? (uint64_t)1 << (sizeof(IntType) * 8 - 1)
+                : (uint64_t)(IntType)~(IntType)0;
+
+        if(value > max - (std::is_signed<IntType>::value && !isNegative)) return 0;
+
+        result = isNegative ? (IntType)(0 - value) : (IntType)value;
+
+        i += ndigits;
+        _cursor += i;
+        return i;
+    }
+
+    size_t parse(int8_t& value)   { return parse_integer<int8_t>(value); }     /// Parses int8_t and advances the cursor
+    size_t parse(uint8_t& value)  { return parse_integer<uint8_t>(value); }    /// Parses uint8_t and advances the cursor
+    size_t parse(int16_t& value)  { return parse_integer<int16_t>(value); }    /// Parses int16_t and advances the cursor
+    size_t parse(uint16_t& value) { return parse_integer<uint16_t>(value); }   /// Parses uint16_t and advances the cursor
+    size_t parse(int32_t& value)  { return parse_integer<int32_t>(value); }    /// Parses int32_t and advances the cursor
+    size_t parse(uint32_t& value) { return parse_integer<uint32_t>(value); }   /// Parses uint32_t and advances the cursor
+    size_t parse(int64_t& value)  { return parse_integer<int64_t>(value); }    /// Parses int64_t and advances the cursor
+    size_t parse(uint64_t& value) { return parse_integer<uint64_t>(value); }   /// Parses uint64_t and advances the cursor
+
+#if TCSB_USE_FP
+    /** Parses a double as written by addf: [+-]digits[.digits][e[+-]digits], inf, nan.
+     *  The result is correctly rounded (round half to even) */
+    size_t parsef(double& result)
+    {
+        const char* s = &_buffer[_cursor];
+        std::size_t avail = remaining();
+        std::size_t i = 0;
+        bool isNegative = false;
+
+        if(i < avail && (s[i] == '-' || s[i] == '+')) {
+            isNegative = s[i] == '-';
+            i++;
+        }
+
+        uint64_t bits;
+
+        if(avail - i >= 3 && (!std::memcmp(s + i, "inf", 3) || !std::memcmp(s + i, "nan", 3))) {
+            bits = s[i] == 'i' ? TCSB_expmask : TCSB_expmask | (TCSB_hiddenbit >> 1);
+            i += 3;
+        } else {
+            /* up to 19 significant digits go to w, the value is w * 10^(exp + e) */
+            std::size_t start = i;
+            uint64_t w = 0;
+            int ndigits = 0;
+            int exp = 0;
+            bool truncated = false;
+            bool sawdigits = false;
+            bool sawdot = false;
+
+            for(; i < avail; i++) {
+                char c = s[i];
+                if(c == '.' && !sawdot) {
+                    sawdot = true;
+                    continue;
+                }
+
+                unsigned digit = (unsigned char)c - '0';
+                if(digit > 9) break;
+
+                sawdigits = true;
+                if(ndigits < 19) {
+                    if(w || digit) {
+                        w = w * 10 + digit;
+                        ndigits++;
+                    }
+                    if(sawdot) exp--;
+                } else {
+                    if(!sawdot) exp++;
+                    if(digit) truncated = true;
+                }
+            }
+
+            if(!sawdigits) return 0;
+            std::size_t len = i - start;
+
+            /* exponent is taken only if it has digits */
+            int e = 0;
+            if(i < avail && (s[i] == 'e' || s[i] == 'E')) {
+                std::size_t j = i + 1;
+                bool isExpNegative = false;
+
+                if(j < avail && (s[j] == '-' || s[j] == '+')) {
+                    isExpNegative = s[j] == '-';
+                    j++;
+                }
+
+                if(j < avail && (unsigned)((unsigned char)s[j] - '0') <= 9) {
+                    for(; j < avail && (unsigned)((unsigned char)s[j] - '0') <= 9; j++) {
+                        if(e < 100000) e = e * 10 + (s[j] - '0');
+                    }
+                    i = j;
+                    if(isExpNegative) e = -e;
+                }
+            }
+
+            if(truncated || !fast_decimal_to_bits(w, exp + e, bits)) {
+                bits = slow_decimal_to_bits(s + start, len, e);
+            }
+        }
+
+        if(isNegative) bits |= TCSB_signmask;
+        result = bits_to_double(bits);
+
+        _cursor += i;
+        return i;
+    }
+#endif //#if TCSB_USE_FP
+
+    /** Skips char c if it is at the cursor */
+    size_t skip(char c)
+    {
+        if(_cursor == _bufferSize || _buffer[_cursor] != c || c == '\0') return 0;
+        _cursor++;
+        return 1;
+    }
+
+    /** Skips spaces and tabs */
+    size_t skip_spaces()
+    {
+        std::size_t start = _cursor;
+        while(_cursor < _bufferSize && (_buffer[_cursor] == ' ' || _buffer[_cursor] == '\t')) _cursor++;
+        return _cursor - start;
+    }
+
+    /** true if the whole input is parsed */
+    bool at_end(void) { return _cursor == _bufferSize || _buffer[_cursor] == '\0'; }
+
+    /** Number of chars parsed so far */
+    size_t position(void) { return _cursor; }
+
+    /** Number of chars left to parse */
+    size_t remaining(void) { return _bufferSize - _cursor; }
+
+    /** Pointer to the first char that is not parsed yet */
+    const char* current(void) { return &_buffer[_cursor]; }
+};
+
+/** A field of the input: points into the input buffer, is not '\0' terminated */
+typedef struct CStringToken {
+    const char* data;
+    std::size_t size;
+} CStringToken;
+
+
+/** Splits a command line like "SET 12 3.5 name" into fields in place, without copying.
+ *  Fields are separated by runs of the delimiter, '\r' and '\n'. Input ends at bufferSize chars or at '\0'.
+ *  Each next call returns the field size and advances to the next field,
+ *  or returns 0 and does not move if there are no fields left or the field is not a number */
+class CStringTokenizer {
+    CStringTokenizer(const CStringTokenizer&) = delete;
+    CStringTokenizer& operator=(const CStringTokenizer&) = delete;
+
+private:
+    const char* _buffer;
+    std::size_t _bufferSize;
+    std::size_t _cursor;
+    char _delimiter;
+
+    bool is_separator(char c) { return c == _delimiter || c == '\r' || c == '\n'; }
+
+    /* length of the field starting at s: up to the first delimiter, '\r', '\n' or '\0' */
+    std::size_t field_size(const char* s, std::size_t avail)
+    {
+        std::size_t i = 0;
+
+#if TCSB_HAS_SWAR
+        for(; avail - i >= 8; i += 8) {
+            uint64_t chunk = TCSB_Swar::load(s + i);
+            uint64_t mask = TCSB_Swar::bytes_equal(chunk, _delimiter) | TCSB_Swar::bytes_equal(chunk, '\r')
+                          | TCSB_Swar::bytes_equal(chunk, '\n') | TCSB_Swar::zero_bytes(chunk);
+            if(mask) return i + TCSB_Swar::first(mask);
+        }
+#endif
+
+        for(; i < avail; i++) {
+            if(is_separator(s[i]) || s[i] == '\0') break;
+        }
+        return i;
+    }
+
+    /* position of the next field without moving there */
+    bool peek(CStringToken& token)
+    {
+        std::size_t i = _cursor;
+        while(i < _bufferSize && is_separator(_buffer[i])) i++;
+
+        if(i == _bufferSize || _buffer[i] == '\0') return false;
+
+        token.data = &_buffer[i];
+        token.size = field_size(token.data, _bufferSize - i);
+        return true;
+    }
+
+    void skip(const CStringToken& token) { _cursor = (std::size_t)(token.data - _buffer) + token.size; }
+
+public:
+    /** Tokenizer over the first bufferSize chars of buffer */
+    CStringTokenizer(const char *buffer, std::size_t bufferSize, char delimiter = ' ') {
+        _buffer = buffer;
+        _bufferSize = bufferSize;
+        _cursor = 0;
+        _delimiter = delimiter;
+    }
+
+    /** Tokenizer over a C string, its length is taken with strlen */
+    explicit CStringTokenizer(const char *str, char delimiter = ' ') {
+        _buffer = str;
+        _bufferSize = std::strlen(str);
+        _cursor = 0;
+        _delimiter = delimiter;
+    }
+
+    /** Takes the next field as is */
+    size_t next(CStringToken& token)
+    {
+        if(!peek(token)) return 0;
+        skip(token);
+        return token.size;
+    }
+
+    /** Takes the next field if the whole field is an integer that fits IntType */
+    template <typename IntType>
+    size_t next_integer(IntType& value)
+    {
+        CStringToken token;
+        if(!peek(token)) return 0;
+
+        CStringParser parser(token.data, token.size);
+        IntType result = 0;
+        if(parser.parse(result) != token.size) return 0;
+
+        value = result;
+        skip(token);
+        return token.size;
+    }
+
+    size_t next(int8_t& value)   { return next_integer<int8_t>(value); }     /// Takes the next field as int8_t
+    size_t next(uint8_t& value)  { return next_integer<uint8_t>(value); }    /// Takes the next field as uint8_t
+    size_t next(int16_t& value)  { return next_integer<int16_t>(value); }    /// Takes the next field as int16_t
+    size_t next(uint16_t& value) { return next_integer<uint16_t>(value); }   /// Takes the next field as uint16_t
+    size_t next(int32_t& value)  { return next_integer<int32_t>(value); }    /// Takes the next field as int32_t
+    size_t next(uint32_t& value) { return next_integer<uint32_t>(value); }   /// Takes the next field as uint32_t
+    size_t next(int64_t& value)  { return next_integer<int64_t>(value); }    /// Takes the next field as int64_t
+    size_t next(uint64_t& value) { return next_integer<uint64_t>(value); }   /// Takes the next field as uint64_t
+
+#if TCSB_USE_FP
+    /** Takes the next field if the whole field is a double. A field the fast path can not round takes
+     *  parsef's exact fallback, about TCSB_PARSE_DECIMAL_DIGITS + 20 bytes (820) of stack */
+    size_t nextf(double& value)
+    {
+        CStringToken token;
+        if(!peek(token)) return 0;
+
+        CStringParser parser(token.data, token.size);
+        double result = 0;
+        if(parser.parsef(result) != token.size) return 0;
+
+        value = result;
+        skip(token);
+        return token.size;
+    }
+#endif //#if TCSB_USE_FP
+
+    /** true if there are no fields left */
+    bool at_end(void)
+    {
+        CStringToken token;
+        return !peek(token);
+    }
+
+    /** Number of chars consumed so far */
+    size_t position(void) { return _cursor; }
+
+    /** Pointer to the first char that is not consumed yet */
+    const char* current(void) { return &_buffer[_cursor]; }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_CSTRINGPARSER_HPP
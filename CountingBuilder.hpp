@@ -0,0 +1,136 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_COUNTINGBUILDER_HPP
+#define HEADERLOCK_COUNTINGBUILDER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if !defined( TCSB_COUNTING_SCRATCH )
+    #define TCSB_COUNTING_SCRATCH (96)      /* fits the longest unit that is never split: a hexdump line */
+#endif
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Dry run builder: takes the same add, addf and operator<< calls and only counts the chars they
+ *  would produce, to size an exact fit buffer or a Content-Length before formatting for real.
+ *  Integers, chars and strings are counted without generating any text, integer length is taken
+ *  from the magnitude 4 digits at a time. Doubles still need their shortest digits, they and the
+ *  rest (encodings, escapes) are formatted into a small scratch buffer that is counted and reused */
+class CountingBuilder : public CStringBuilder {
+    CountingBuilder(const CountingBuilder&) = delete;
+    CountingBuilder& operator=(const CountingBuilder&) = delete;
+
+private:
+    char _scratch[TCSB_COUNTING_SCRATCH];
+    std::size_t _counted;
+
+    static void on_flush(CStringBuilder&, void* context)
+    {
+        CountingBuilder* self = static_cast<CountingBuilder*>(context);
+        self->_counted += self->_cursor;
+    }
+
+    template <typename IntType>
+    size_t count_integer(IntType n)
+    {
+        std::size_t length = integer_length(n);
+        _counted += length;
+        return length;
+    }
+
+public:
+    CountingBuilder(): CStringBuilder(_scratch, sizeof(_scratch)), _counted(0)
+    {
+        set_flush_hook(on_flush, this);
+    }
+
+    using CStringBuilder::add;
+
+    /** Counts a C string up to size chars or its '\0' */
+    template<class CharConstPtr>
+    size_t add(CharConstPtr array, std::size_t size)
+    {
+        const char* end = (const char*)std::memchr(&array[0], '\0', size);
+        std::size_t length = end ? (std::size_t)(end - &array[0]) : size;
+        _counted += length;
+        return length;
+    }
+
+    template <std::size_t SIZE>
+    size_t add(const char (&array)[SIZE]) { return add(&array[0], SIZE); }
+
+    size_t add_bytes(const char*, std::size_t size) { _counted += size; return size; }
+
+    size_t add(char)           { _counted++; return 1; }
+    size_t add(bool)           { _counted++; return 1; }
+    size_t add(int8_t value)   { return count_integer(value); }
+    size_t add(uint8_t value)  { return count_integer(value); }
+    size_t add(int16_t value)  { return count_integer(value); }
+    size_t add(uint16_t value) { return count_integer(value); }
+    size_t add(int32_t value)  { return count_integer(value); }
+    size_t add(uint32_t value) { return count_integer(value); }
+    size_t add(int64_t value)  { return count_integer(value); }
+    size_t add(uint64_t value) { return count_integer(value); }
+
+    template <typename IntType>
+    size_t add_integer(IntType n) { return count_integer(n); }
+
+    /** Chars added so far */
+    size_t size() { return _counted + _cursor; }
+
+    /** Starts counting from zero */
+    void reset()
+    {
+        _counted = 0;
+        _cursor = 0;
+        _hookCursor = 0;
+        _scratch[0] = '\0';
+    }
+};
+
+/* the shortcuts above are taken by operator<< as well, everything else goes the CStringBuilder way */
+template <typename T>
+inline CountingBuilder& operator<<(CountingBuilder& sb, const T& value) { static_cast<CStringBuilder&>(sb) << value; return sb; }
+
+inline CountingBuilder& operator<<(CountingBuilder& sb, char value)     { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, bool value)     { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, int8_t value)   { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, uint8_t value)  { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, int16_t value)  { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, uint16_t value) { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, int32_t value)  { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, uint32_t value) { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, int64_t value)  { sb.add(value); return sb; }
+inline CountingBuilder& operator<<(CountingBuilder& sb, uint64_t value) { sb.add(value); return sb; }
+
+template <std::size_t SIZE>
+inline CountingBuilder& operator<<(CountingBuilder& sb, const char (&array)[SIZE]) { sb.add(array); return sb; }
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_COUNTINGBUILDER_HPP
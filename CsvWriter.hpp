@@ -0,0 +1,170 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_CSVWRITER_HPP
+#define HEADERLOCK_CSVWRITER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Writes CSV/TSV rows into a CStringBuilder. Delimiters are put automatically. A string field is quoted
+ *  (with quotes doubled) only if it has the delimiter, a quote or a line break, otherwise it is copied as is */
+class CsvWriter {
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+private:
+    CStringBuilder& _sb;
+    char _delimiter;
+    bool _rowStarted;
+
+    void separate()
+    {
+        if(_rowStarted) _sb.add(_delimiter);
+        _rowStarted = true;
+    }
+
+    /* index of the first char that is the delimiter, a quote or a line break, or size */
+    std::size_t plain_run_end(const char* s, std::size_t i, std::size_t size, bool quotesOnly)
+    {
+#if TCSB_HAS_SWAR
+        for(; size - i >= 8; i += 8) {
+            uint64_t chunk = TCSB_Swar::load(s + i);
+            uint64_t mask = TCSB_Swar::bytes_equal(chunk, '"');
+            if(!quotesOnly) {
+                mask |= TCSB_Swar::bytes_equal(chunk, _delimiter) | TCSB_Swar::bytes_equal(chunk, '\n')
+                      | TCSB_Swar::bytes_equal(chunk, '\r');
+            }
+            if(mask) return i + TCSB_Swar::first(mask);
+        }
+#endif
+        for(; i < size; i++) {
+            char c = s[i];
+            if(c == '"' || (!quotesOnly && (c == _delimiter || c == '\n' || c == '\r'))) break;
+        }
+        return i;
+    }
+
+    void add_string(const char* s, std::size_t size)
+    {
+        if(plain_run_end(s, 0, size, false) == size) {
+            _sb.add_bytes(s, size);
+            return;
+        }
+
+        _sb.add('"');
+
+        std::size_t run = 0;
+        std::size_t from = 0;
+        while(true) {
+            std::size_t i = plain_run_end(s, from, size, true);
+            if(i == size) {
+                _sb.add_bytes(s + run, i - run);
+                break;
+            }
+
+            /* copy the quote with the run and start the next run from it again: "" */
+            _sb.add_bytes(s + run, i + 1 - run);
+            run = i;
+            from = i + 1;
+        }
+
+        _sb.add('"');
+    }
+
+public:
+    /** delimiter is ',' for CSV, '\t' for TSV */
+    explicit CsvWriter(CStringBuilder& sb, char delimiter = ','): _sb(sb), _delimiter(delimiter), _rowStarted(false) {}
+
+    /** String field, quoted only if needed */
+    CsvWriter& field(const char* s, std::size_t size)
+    {
+        separate();
+        add_string(s, size);
+        return *this;
+    }
+
+    CsvWriter& field(const char* s) { return field(s, std::strlen(s)); }
+
+    template <typename IntType>
+    CsvWriter& field_integer(IntType value)
+    {
+        separate();
+        _sb.add(value);
+        return *this;
+    }
+
+    CsvWriter& field(bool value)     { return field_integer<uint8_t>((uint8_t)value); }   /// Adds bool as 0 or 1
+    CsvWriter& field(int8_t value)   { return field_integer<int8_t>(value); }     /// Adds int8_t field
+    CsvWriter& field(uint8_t value)  { return field_integer<uint8_t>(value); }    /// Adds uint8_t field
+    CsvWriter& field(int16_t value)  { return field_integer<int16_t>(value); }    /// Adds int16_t field
+    CsvWriter& field(uint16_t value) { return field_integer<uint16_t>(value); }   /// Adds uint16_t field
+    CsvWriter& field(int32_t value)  { return field_integer<int32_t>(value); }    /// Adds int32_t field
+    CsvWriter& field(uint32_t value) { return field_integer<uint32_t>(value); }   /// Adds uint32_t field
+    CsvWriter& field(int64_t value)  { return field_integer<int64_t>(value); }    /// Adds int64_t field
+    CsvWriter& field(uint64_t value) { return field_integer<uint64_t>(value); }   /// Adds uint64_t field
+
+#if TCSB_USE_FP
+    /** Shortest round trip double, plain or scientific whatever the builder notation so that it can be read back */
+    CsvWriter& field(double value)
+    {
+        separate();
+        _sb.addf(value, CStringBuilder::FP_AUTO);
+        return *this;
+    }
+#endif //#if TCSB_USE_FP
+
+    /** Empty field */
+    CsvWriter& empty_field()
+    {
+        separate();
+        return *this;
+    }
+
+    /** Ends the row with '\n' */
+    CsvWriter& end_row()
+    {
+        _sb.add('\n');
+        _rowStarted = false;
+        return *this;
+    }
+
+    /** Writes a whole row: csv.row(t, x, "name") */
+    CsvWriter& row() { return end_row(); }
+
+    template <typename FieldType, typename... Rest>
+    CsvWriter& row(FieldType value, Rest... rest)
+    {
+        field(value);
+        return row(rest...);
+    }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_CSVWRITER_HPP
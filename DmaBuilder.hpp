@@ -0,0 +1,126 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_DMABUILDER_HPP
+#define HEADERLOCK_DMABUILDER_HPP
+
+#include "CStringBuilder.hpp"
+#include <atomic>
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Starts an asynchronous transfer of size bytes at data, e.g. HAL_UART_Transmit_DMA. It is called
+ *  from the builder or from transmit_complete(), so in the DMA interrupt too. It must not block */
+typedef void (*DmaTransmit)(const char* data, std::size_t size, void* context);
+
+/** Builder over COUNT buffers for DMA output: when a buffer is full it is handed to transmit and
+ *  formatting goes on in the next buffer while the transfer runs. Call transmit_complete() from the DMA
+ *  complete interrupt: it frees the buffer and starts the next full one, so transfers are chained
+ *  without the main loop. The builder waits (spins) only when all buffers are full or in flight.
+ *  Sequence counters are lock-free atomics, a transfer is started by exactly one side */
+template <std::size_t COUNT = 2>
+class DmaBuilder : public CStringBuilder {
+    static_assert(COUNT >= 2, "DmaBuilder needs at least two buffers");
+
+private:
+    char* _buffers;
+    std::size_t _size;                      /* of each buffer */
+    DmaTransmit _transmit;
+    void* _context;
+    std::size_t _lengths[COUNT];            /* of full buffers */
+    std::atomic<uint32_t> _submitted;       /* buffers handed over, the next one is being filled */
+    std::atomic<uint32_t> _started;         /* transfers started */
+    std::atomic<uint32_t> _completed;       /* transfers completed */
+
+    static void on_flush(CStringBuilder&, void* context)
+    {
+        static_cast<DmaBuilder*>(context)->submit();
+    }
+
+    /* starts the next full buffer if the DMA is idle, from the builder or the interrupt */
+    void try_start()
+    {
+        uint32_t next = _started.load();
+
+        if(next == _completed.load() && next != _submitted.load()
+                && _started.compare_exchange_strong(next, next + 1)) {
+            std::size_t index = next % COUNT;
+            _transmit(_buffers + index * _size, _lengths[index], _context);
+        }
+    }
+
+    /* hands the filled buffer over and moves to the next one as soon as it is free */
+    void submit()
+    {
+        uint32_t seq = _submitted.load();
+
+        _lengths[seq % COUNT] = _cursor;
+        _submitted.store(++seq);
+        try_start();
+
+        while(seq - _completed.load() >= COUNT) {}     /* the next buffer is still in flight */
+        _buffer = _buffers + (seq % COUNT) * _size;
+    }
+
+public:
+    /** buffer is split into COUNT buffers of bufferSize / COUNT bytes */
+    DmaBuilder(char *buffer, std::size_t bufferSize, DmaTransmit transmit, void* context = nullptr):
+        CStringBuilder(buffer, bufferSize / COUNT),
+        _buffers(buffer), _size(bufferSize / COUNT), _transmit(transmit), _context(context),
+        _submitted(0), _started(0), _completed(0)
+    {
+        set_flush_hook(on_flush, this);
+    }
+
+    template <std::size_t SIZE>
+        DmaBuilder(char(&array)[SIZE], DmaTransmit transmit, void* context = nullptr):
+        DmaBuilder(array, SIZE, transmit, context) {}
+
+    /** Call from the DMA transfer complete interrupt (or the thread standing in for it) */
+    void transmit_complete()
+    {
+        _completed.store(_completed.load() + 1);
+        try_start();
+    }
+
+    /** Hands what is in the current buffer to the DMA without waiting for the transfer */
+    void flush() { flush_buffer(); }
+
+    /** true if all handed over buffers are transmitted */
+    bool idle() { return _completed.load() == _submitted.load(); }
+
+    /** Flushes and waits (spins) until everything is transmitted */
+    void drain()
+    {
+        flush();
+        while(!idle()) {}
+    }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_DMABUILDER_HPP
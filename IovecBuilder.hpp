@@ -0,0 +1,127 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_IOVECBUILDER_HPP
+#define HEADERLOCK_IOVECBUILDER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Builder that collects the output as a scatter-gather list instead of one string. Text added with
+ *  add_ref() is not copied, a reference to it goes to the list. Everything else (numbers, strings,
+ *  encodings) is formatted into the builder's buffer as usual and the runs of it between references
+ *  are referenced in turn. String literals are copied too: C++ can not tell them from a const char
+ *  array on the stack, so only the caller knows the text outlives the list. IoVec is struct iovec
+ *  for writev()/sendmsg() or any struct with iov_base and iov_len members. Referenced text has to stay
+ *  in place until the list is sent. When the list is full references are copied instead */
+template <typename IoVec, std::size_t MAX_SEGMENTS = 16>
+class IovecBuilder : public CStringBuilder {
+private:
+    IoVec _iov[MAX_SEGMENTS];
+    std::size_t _count;
+    std::size_t _runStart;      /* buffer text after this is not in the list yet */
+
+public:
+    IovecBuilder(char *buffer, std::size_t bufferSize): CStringBuilder(buffer, bufferSize), _count(0), _runStart(0) {}
+
+    template <std::size_t SIZE>
+        explicit IovecBuilder(char(&array)[SIZE]): CStringBuilder(array), _count(0), _runStart(0) {}
+
+    /** References size bytes of text that stays in place until the list is sent */
+    size_t add_ref(const char* data, std::size_t size)
+    {
+        if(size == 0) return 0;
+
+        bool run = _cursor > _runStart;
+
+        /* one entry is kept for the buffer text that may follow */
+        if(_count + run + 2 > MAX_SEGMENTS) return add_bytes(data, size);
+
+        if(run) {
+            _iov[_count].iov_base = &_buffer[_runStart];
+            _iov[_count].iov_len = _cursor - _runStart;
+            _count++;
+            _runStart = _cursor;
+        }
+
+        _iov[_count].iov_base = const_cast<char*>(data);
+        _iov[_count].iov_len = size;
+        _count++;
+        return size;
+    }
+
+    /** References a literal or another array that stays in place, up to its '\0' */
+    template <std::size_t SIZE>
+    size_t add_ref(const char (&array)[SIZE])
+    {
+        const char* end = (const char*)std::memchr(array, '\0', SIZE);
+        return add_ref(array, end ? (std::size_t)(end - array) : SIZE);
+    }
+
+    /** The list, iov_count() entries */
+    IoVec* iov()
+    {
+        if(_cursor > _runStart) {
+            _iov[_count].iov_base = &_buffer[_runStart];
+            _iov[_count].iov_len = _cursor - _runStart;
+        }
+        return _iov;
+    }
+
+    std::size_t iov_count() { return _count + (_cursor > _runStart); }
+
+    /** Length of the whole text */
+    size_t size()
+    {
+        IoVec* iov = this->iov();
+        std::size_t size = 0;
+
+        for(std::size_t i = 0; i < iov_count(); i++) size += iov[i].iov_len;
+        return size;
+    }
+
+    /** Empties the list and the buffer */
+    void clear()
+    {
+        rebind(_buffer, _bufferSize);
+        _count = 0;
+        _runStart = 0;
+    }
+};
+
+/* operator<< copies everything the CStringBuilder way and keeps the IovecBuilder type for chaining */
+template <typename IoVec, std::size_t MAX_SEGMENTS, typename T>
+inline IovecBuilder<IoVec, MAX_SEGMENTS>& operator<<(IovecBuilder<IoVec, MAX_SEGMENTS>& sb, const T& value)
+{
+    static_cast<CStringBuilder&>(sb) << value;
+    return sb;
+}
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_IOVECBUILDER_HPP
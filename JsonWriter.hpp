@@ -0,0 +1,235 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_JSONWRITER_HPP
+#define HEADERLOCK_JSONWRITER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Writes JSON into a CStringBuilder: commas are put automatically, strings are escaped.
+ *  Nesting depth is limited to 31, deeper objects and arrays are left out and an unmatched end is ignored.
+ *  If the buffer gets full or the nesting is too deep the output is cut, check builder is_overflow() */
+class JsonWriter {
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+private:
+    CStringBuilder& _sb;
+    uint32_t _hasItems;     /// bit per nesting level: the level already has a value
+    uint8_t _depth;
+    uint8_t _refused;       /// opens past the maximum depth, their closes are dropped too
+    bool _afterKey;
+
+    static const uint8_t MAX_DEPTH = 31;
+
+    /* comma before every value except the first one in an object or array and values after keys */
+    void separate()
+    {
+        if(_afterKey) {
+            _afterKey = false;
+            return;
+        }
+
+        uint32_t bit = (uint32_t)1 << _depth;
+        if(_hasItems & bit) _sb.add(',');
+        _hasItems |= bit;
+    }
+
+    JsonWriter& open(char bracket)
+    {
+        if(_depth >= MAX_DEPTH) {
+            /* one more level does not fit into _hasItems: the document is cut as in a full buffer */
+            if(_refused < 255) _refused++;
+            _sb.set_overflow();
+            return *this;
+        }
+
+        separate();
+        _sb.add(bracket);
+        _depth++;
+        _hasItems &= ~((uint32_t)1 << _depth);
+        return *this;
+    }
+
+    JsonWriter& close(char bracket)
+    {
+        if(_refused) {
+            _refused--;
+            return *this;
+        }
+        if(_depth == 0) return *this;     /* nothing is open */
+
+        _depth--;
+        _sb.add(bracket);
+        return *this;
+    }
+
+    static bool needs_escape(char c) { return (unsigned char)c < 0x20 || c == '"' || c == '\\'; }
+
+    /* index of the first char that needs escaping or size */
+    static std::size_t clean_run_end(const char* s, std::size_t i, std::size_t size)
+    {
+#if TCSB_HAS_SWAR
+        for(; size - i >= 8; i += 8) {
+            uint64_t chunk = TCSB_Swar::load(s + i);
+            uint64_t mask = TCSB_Swar::bytes_less(chunk, 0x20) | TCSB_Swar::bytes_equal(chunk, '"')
+                          | TCSB_Swar::bytes_equal(chunk, '\\');
+            if(mask) return i + TCSB_Swar::first(mask);
+        }
+#endif
+        for(; i < size; i++) {
+            if(needs_escape(s[i])) break;
+        }
+        return i;
+    }
+
+    void add_escape(char c)
+    {
+        static const char hex_digits[] = "0123456789abcdef";
+        char escape[6] = { '\\', 'u', '0', '0',
+                           hex_digits[(unsigned char)c >> 4], hex_digits[(unsigned char)c & 0xF] };
+        std::size_t size = 2;
+
+        switch(c) {
+            case '"':  escape[1] = '"';  break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b';  break;
+            case '\f': escape[1] = 'f';  break;
+            case '\n': escape[1] = 'n';  break;
+            case '\r': escape[1] = 'r';  break;
+            case '\t': escape[1] = 't';  break;
+            default:   size = 6;
+        }
+
+        _sb.add_bytes(escape, size);
+    }
+
+    /* clean runs are copied with memcpy */
+    void add_string(const char* s, std::size_t size)
+    {
+        _sb.add('"');
+
+        std::size_t run = 0;
+        while(true) {
+            std::size_t i = clean_run_end(s, run, size);
+            if(i > run) _sb.add_bytes(s + run, i - run);
+            if(i == size) break;
+
+            add_escape(s[i]);
+            run = i + 1;
+        }
+
+        _sb.add('"');
+    }
+
+public:
+    explicit JsonWriter(CStringBuilder& sb): _sb(sb), _hasItems(0), _depth(0), _refused(0), _afterKey(false) {}
+
+    JsonWriter& begin_object() { return open('{'); }     /// {
+    JsonWriter& end_object()   { return close('}'); }    /// }
+    JsonWriter& begin_array()  { return open('['); }     /// [
+    JsonWriter& end_array()    { return close(']'); }    /// ]
+
+    /** Object member name, the next value belongs to it */
+    JsonWriter& key(const char* name, std::size_t size)
+    {
+        separate();
+        add_string(name, size);
+        _sb.add(':');
+        _afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& key(const char* name) { return key(name, std::strlen(name)); }
+
+    /** Escaped string value */
+    JsonWriter& value(const char* s, std::size_t size)
+    {
+        separate();
+        add_string(s, size);
+        return *this;
+    }
+
+    JsonWriter& value(const char* s) { return value(s, std::strlen(s)); }
+
+    JsonWriter& value(bool value)
+    {
+        separate();
+        if(value) _sb.add("true"); else _sb.add("false");
+        return *this;
+    }
+
+    JsonWriter& value_null()
+    {
+        separate();
+        _sb.add("null");
+        return *this;
+    }
+
+    template <typename IntType>
+    JsonWriter& value_integer(IntType value)
+    {
+        separate();
+        _sb.add(value);
+        return *this;
+    }
+
+    JsonWriter& value(int8_t value)   { return value_integer<int8_t>(value); }     /// Adds int8_t value
+    JsonWriter& value(uint8_t value)  { return value_integer<uint8_t>(value); }    /// Adds uint8_t value
+    JsonWriter& value(int16_t value)  { return value_integer<int16_t>(value); }    /// Adds int16_t value
+    JsonWriter& value(uint16_t value) { return value_integer<uint16_t>(value); }   /// Adds uint16_t value
+    JsonWriter& value(int32_t value)  { return value_integer<int32_t>(value); }    /// Adds int32_t value
+    JsonWriter& value(uint32_t value) { return value_integer<uint32_t>(value); }   /// Adds uint32_t value
+    JsonWriter& value(int64_t value)  { return value_integer<int64_t>(value); }    /// Adds int64_t value
+    JsonWriter& value(uint64_t value) { return value_integer<uint64_t>(value); }   /// Adds uint64_t value
+
+#if TCSB_USE_FP
+    /** Shortest round trip double, inf and nan are written as null as JSON has no such numbers */
+    JsonWriter& value(double value)
+    {
+        if(std::isnan(value) || std::isinf(value)) return value_null();
+
+        separate();
+        _sb.addf(value, CStringBuilder::FP_AUTO);
+        return *this;
+    }
+#endif //#if TCSB_USE_FP
+
+    /** key(name).value(value) */
+    template <typename ValueType>
+    JsonWriter& member(const char* name, ValueType value)
+    {
+        key(name);
+        return this->value(value);
+    }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_JSONWRITER_HPP
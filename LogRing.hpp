@@ -0,0 +1,149 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_LOGRING_HPP
+#define HEADERLOCK_LOGRING_HPP
+
+#include "CStringBuilder.hpp"
+#include <atomic>
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Lock-free multi-producer single-consumer ring of log records, SLOTS records of up to SLOT_SIZE - 1 chars.
+ *  A producer (task, ISR or thread) reserves a slot, formats right into it with a LogRing::Record builder
+ *  and commits; nothing is copied and no lock is taken. When the ring is full the record is dropped
+ *  (and counted) instead of waiting, so producing from interrupts is safe. The consumer drains
+ *  committed records in order. Based on the bounded queue of Dmitry Vyukov: every slot has a sequence
+ *  number telling whether it is free or committed for the current lap */
+template <std::size_t SLOTS = 64, std::size_t SLOT_SIZE = 128>
+class LogRing {
+    static_assert(SLOTS >= 2 && (SLOTS & (SLOTS - 1)) == 0, "LogRing SLOTS must be a power of 2");
+    static_assert(SLOT_SIZE >= 2, "LogRing SLOT_SIZE must hold at least one char");
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;      /* == position: free, == position + 1: committed */
+        std::size_t size;
+        char text[SLOT_SIZE];
+    };
+
+    Slot _slots[SLOTS];
+    alignas(64) std::atomic<uint32_t> _head;    /* next position to reserve */
+    std::atomic<uint32_t> _dropped;
+    alignas(64) uint32_t _tail;                 /* next position to drain, consumer only */
+
+    /* claims the position at head unless its slot is still in use by the previous lap */
+    bool reserve(uint32_t& pos)
+    {
+        pos = _head.load(std::memory_order_relaxed);
+
+        while(true) {
+            uint32_t seq = _slots[pos % SLOTS].seq.load(std::memory_order_acquire);
+            int32_t lap = (int32_t)(seq - pos);
+
+            if(lap == 0) {
+                if(_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return true;
+            } else if(lap < 0) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    LogRing(): _head(0), _dropped(0), _tail(0)
+    {
+        for(uint32_t i = 0; i < SLOTS; i++) _slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    /** Builder bound to a reserved slot, committed by commit() or on destruction:
+     *  { LogRing<>::Record line(ring); line << "t=" << t; }
+     *  If the ring is full nothing is written (reserved() is false) */
+    class Record : public CStringBuilder {
+    private:
+        LogRing& _ring;
+        Slot* _slot;
+        uint32_t _pos;
+        char _none[1];
+
+    public:
+        explicit Record(LogRing& ring): CStringBuilder(_none, 1), _ring(ring), _slot(nullptr), _pos(0)
+        {
+            if(_ring.reserve(_pos)) {
+                _slot = &_ring._slots[_pos % SLOTS];
+                rebind(_slot->text, SLOT_SIZE);
+            }
+        }
+
+        ~Record() { commit(); }
+
+        /** false if the ring was full and the record is dropped */
+        bool reserved() { return _slot != nullptr; }
+
+        /** Publishes the record to the consumer, nothing can be added after it */
+        void commit()
+        {
+            if(!_slot) return;
+
+            _slot->size = _cursor;
+            _slot->seq.store(_pos + 1, std::memory_order_release);
+            _slot = nullptr;
+            rebind(_none, 1);
+        }
+    };
+
+    /** Hands committed records in order to sink(const char* text, std::size_t size) and frees their slots.
+     *  Stops at the first record not committed yet. Single consumer only. Returns the number of records */
+    template <typename Sink>
+    std::size_t drain(Sink sink)
+    {
+        std::size_t count = 0;
+
+        while(true) {
+            Slot& slot = _slots[_tail % SLOTS];
+            if(slot.seq.load(std::memory_order_acquire) != _tail + 1) break;
+
+            sink((const char*)slot.text, slot.size);
+            slot.seq.store(_tail + SLOTS, std::memory_order_release);
+            _tail++;
+            count++;
+        }
+        return count;
+    }
+
+    /** Records dropped because the ring was full */
+    uint32_t dropped() { return _dropped.load(std::memory_order_relaxed); }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_LOGRING_HPP
@@ -0,0 +1,146 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_MAPPEDFILEBUILDER_HPP
+#define HEADERLOCK_MAPPEDFILEBUILDER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Builder that formats straight into a memory mapped output file, for large exports on Linux hosts.
+ *  The file and its mapping grow by step bytes (posix_fallocate + mremap) when the text reaches the end
+ *  and the mapping is marked for sequential access. close() (or the destructor) cuts the file to
+ *  the exact text size. If the file can not be opened or grown the text is cut as in a full buffer,
+ *  the blocks are allocated up front so a full disk fails the growth instead of raising SIGBUS.
+ *  size() and cstr() cover the whole file. Growing may move the mapping (MREMAP_MAYMOVE), so a
+ *  pointer from cstr() is only good until the next add, take it again after writing */
+class MappedFileBuilder : public CStringBuilder {
+    MappedFileBuilder(const MappedFileBuilder&) = delete;
+    MappedFileBuilder& operator=(const MappedFileBuilder&) = delete;
+
+private:
+    int _fd;
+    char* _map;
+    std::size_t _mapSize;
+    std::size_t _step;
+    std::size_t _offset;        /* file offset the builder's buffer starts at */
+    char _none[1];
+
+    /* the text reached the end of the mapping: grow the file and the mapping, go on where the text ends */
+    static void on_flush(CStringBuilder&, void* context)
+    {
+        MappedFileBuilder* self = static_cast<MappedFileBuilder*>(context);
+        std::size_t offset = self->_offset + self->_cursor;
+
+        if(!self->grow()) {
+            self->_offset = offset;
+            self->rebind(self->_none, 1);
+            self->_isOverflow = true;
+            return;
+        }
+
+        self->_offset = offset;
+        self->rebind(self->_map + offset, self->_mapSize - offset);
+    }
+
+    bool grow()
+    {
+        std::size_t size = _mapSize + _step;
+
+        /* not ftruncate: a sparse file would raise SIGBUS on the first write to a page the disk has no room for */
+        if(posix_fallocate(_fd, (off_t)_mapSize, (off_t)_step) != 0) return false;
+
+        void* map = _map ? mremap(_map, _mapSize, size, MREMAP_MAYMOVE)
+                         : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if(map == MAP_FAILED) return false;
+
+        madvise(map, size, MADV_SEQUENTIAL);
+        _map = (char*)map;
+        _mapSize = size;
+        return true;
+    }
+
+public:
+    /** Creates or truncates the file at path, step is rounded up to whole pages */
+    explicit MappedFileBuilder(const char* path, std::size_t step = 64 << 20):
+            CStringBuilder(_none, 1), _map(nullptr), _mapSize(0), _offset(0)
+    {
+        std::size_t page = (std::size_t)sysconf(_SC_PAGESIZE);
+        _step = step ? (step + page - 1) / page * page : page;
+
+        _fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(_fd < 0 || !grow()) return;
+
+        rebind(_map, _mapSize);
+        set_flush_hook(on_flush, this);
+    }
+
+    ~MappedFileBuilder() { close(); }
+
+    /** false if the file could not be opened and mapped */
+    bool is_open() { return _map != nullptr; }
+
+    /** Length of the text in the file */
+    size_t size() { return _offset + (_buffer != _none ? _cursor : 0); }
+
+    /** Start of the text, invalid once an add grows the mapping */
+    char* cstr() { return _map ? _map : _none; }
+
+    /** Unmaps the file and cuts it to the text size, returns false if any of it failed */
+    bool close()
+    {
+        bool ok = true;
+        std::size_t size = this->size();
+
+        if(_map) ok = munmap(_map, _mapSize) == 0;
+        if(_fd >= 0) {
+            ok = ftruncate(_fd, (off_t)size) == 0 && ok;
+            ok = ::close(_fd) == 0 && ok;
+        }
+
+        _map = nullptr;
+        _mapSize = 0;
+        _fd = -1;
+        _offset = size;
+        set_flush_hook(nullptr, nullptr);
+        rebind(_none, 1);
+        return ok;
+    }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //defined(__linux__)
+
+#endif //HEADERLOCK_MAPPEDFILEBUILDER_HPP
@@ -0,0 +1,199 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_PARALLELFORMAT_HPP
+#define HEADERLOCK_PARALLELFORMAT_HPP
+
+#include "CStringBuilder.hpp"
+#include <thread>
+
+#if !defined( TCSB_PARALLEL_MAX_THREADS )
+    #define TCSB_PARALLEL_MAX_THREADS (16)
+#endif
+
+#if !defined( TCSB_PARALLEL_MIN_VALUES )
+    #define TCSB_PARALLEL_MIN_VALUES (1024)      /* values per thread below which threads do not pay off */
+#endif
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Formats a large array of numbers with several threads, the text is the same as adding the values
+ *  one by one with sep between them. The array is split into one chunk per thread and done in two passes:
+ *  each thread measures its chunk, a prefix sum over the chunk lengths gives every chunk its offset,
+ *  then each thread writes its chunk in place. If the text does not fit, the builder streams or the array
+ *  is small the values are added on the calling thread */
+class ParallelFormat {
+private:
+    template <typename Format>
+    static size_t run(CStringBuilder& sb, std::size_t n, char sep, unsigned threads, Format& format)
+    {
+        std::size_t lengths[TCSB_PARALLEL_MAX_THREADS + 1];
+        std::thread workers[TCSB_PARALLEL_MAX_THREADS];
+
+        if(threads == 0) threads = std::thread::hardware_concurrency();
+        threads = (unsigned)TCSB_minv((std::size_t)threads, n / TCSB_PARALLEL_MIN_VALUES);
+        threads = TCSB_minv(threads, (unsigned)TCSB_PARALLEL_MAX_THREADS);
+
+        if(threads < 2 || sb._flushHook || sb._cursor >= sb.write_limit()) return format.serial(0, n);
+
+        /* pass 1: length of each chunk with the separators before its values */
+        for(unsigned k = 1; k < threads; k++) {
+            workers[k] = std::thread([&, k]() { lengths[k] = format.measure(k * n / threads, (k + 1) * n / threads); });
+        }
+        lengths[0] = format.measure(0, n / threads);
+        for(unsigned k = 1; k < threads; k++) workers[k].join();
+
+        /* prefix sum: lengths[k] becomes the offset of the separator before chunk k */
+        std::size_t total = threads - 1;
+        for(unsigned k = 0; k < threads; k++) total += lengths[k];
+
+        if(total > sb.write_limit() - 1 - sb._cursor) return format.serial(0, n);
+
+        for(unsigned k = threads - 1; k > 0; k--) lengths[k] = lengths[k - 1];
+        for(unsigned k = 2; k < threads; k++) lengths[k] += lengths[k - 1] + 1;
+        lengths[threads] = total;
+
+        /* pass 2: chunk k is written after its leading separator, its '\0' lands on the next separator */
+        char *base = &sb._buffer[sb._cursor];
+        for(unsigned k = 1; k < threads; k++) {
+            workers[k] = std::thread([&, k]() {
+                format.write(base + lengths[k] + 1, lengths[k + 1] - lengths[k], k * n / threads, (k + 1) * n / threads);
+            });
+        }
+        format.write(base, lengths[1] + 1, 0, n / threads);
+        for(unsigned k = 1; k < threads; k++) workers[k].join();
+
+        for(unsigned k = 1; k < threads; k++) base[lengths[k]] = sep;
+        sb._cursor += total;
+        sb.set_string_end();
+        return total;
+    }
+
+    template <typename IntType>
+    struct IntFormat {
+        CStringBuilder& sb;
+        const IntType* values;
+        char sep;
+
+        std::size_t measure(std::size_t from, std::size_t to)
+        {
+            std::size_t length = 0;
+            for(std::size_t i = from; i < to; i++) length += CStringBuilder::integer_length(values[i]);
+            return length + (to - from - 1);
+        }
+
+        void write(char *dest, std::size_t size, std::size_t from, std::size_t to)
+        {
+            CStringBuilder chunk(dest, size);
+            for(std::size_t i = from; i < to; i++) {
+                if(i != from) chunk.add(sep);
+                chunk.add_integer(values[i]);
+            }
+        }
+
+        size_t serial(std::size_t from, std::size_t to)
+        {
+            std::size_t start = sb._cursor;
+            for(std::size_t i = from; i < to; i++) {
+                if(i && !sb.add(sep)) break;
+                if(!sb.add_integer(values[i])) break;
+            }
+            return sb._cursor - start;
+        }
+    };
+
+#if TCSB_USE_FP
+    struct DoubleFormat {
+        CStringBuilder& sb;
+        const double* values;
+        char sep;
+        CStringBuilder::FpNotation notation;
+
+        /* doubles have no length shortcut, they are formatted aside and only counted */
+        std::size_t measure(std::size_t from, std::size_t to)
+        {
+            char digits[CStringBuilder::FP_MAX_LENGTH];
+            CStringBuilder scratch(digits, sizeof(digits));
+            std::size_t length = 0;
+            for(std::size_t i = from; i < to; i++) length += scratch.fpconv_dtoa(values[i], digits, notation);
+            return length + (to - from - 1);
+        }
+
+        void write(char *dest, std::size_t size, std::size_t from, std::size_t to)
+        {
+            char digits[CStringBuilder::FP_MAX_LENGTH];
+            CStringBuilder chunk(dest, size);
+            for(std::size_t i = from; i < to; i++) {
+                if(i != from) chunk.add(sep);
+                if(chunk._bufferSize - chunk._cursor >= CStringBuilder::FP_MAX_LENGTH + 1) {
+                    chunk._cursor += chunk.fpconv_dtoa(values[i], &chunk._buffer[chunk._cursor], notation);
+                } else {
+                    /* the end of the chunk is formatted aside, dtoa may need FP_MAX_LENGTH chars */
+                    chunk.add_bytes(digits, chunk.fpconv_dtoa(values[i], digits, notation));
+                }
+            }
+            chunk.set_string_end();
+        }
+
+        size_t serial(std::size_t from, std::size_t to)
+        {
+            std::size_t start = sb._cursor;
+            for(std::size_t i = from; i < to; i++) {
+                if(i && !sb.add(sep)) break;
+                if(!sb.addf(values[i], notation)) break;
+            }
+            return sb._cursor - start;
+        }
+    };
+#endif
+
+public:
+    /** Adds n integers separated by sep using up to threads threads (0 - one per core),
+     *  returns the number of chars added */
+    template <typename IntType>
+    static size_t add_array(CStringBuilder& sb, const IntType* values, std::size_t n, char sep, unsigned threads = 0)
+    {
+        if(n == 0) return 0;
+        IntFormat<IntType> format = {sb, values, sep};
+        return run(sb, n, sep, threads, format);
+    }
+
+#if TCSB_USE_FP
+    /** Adds n doubles in the builder's notation separated by sep using up to threads threads (0 - one per core),
+     *  returns the number of chars added */
+    static size_t add_array(CStringBuilder& sb, const double* values, std::size_t n, char sep, unsigned threads = 0)
+    {
+        if(n == 0) return 0;
+        DoubleFormat format = {sb, values, sep, sb._fpNotation};
+        return run(sb, n, sep, threads, format);
+    }
+#endif
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_PARALLELFORMAT_HPP
@@ -0,0 +1,185 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_ROPEBUILDER_HPP
+#define HEADERLOCK_ROPEBUILDER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Caller memory cut into fixed size chunks. Free chunks are kept in a list threaded through
+ *  the chunks themselves, so the pool takes no memory of its own. Not thread safe */
+class ChunkPool {
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+private:
+    char* _free;
+    std::size_t _chunkSize;
+    std::size_t _available;
+
+public:
+    /** chunkSize has to hold a pointer */
+    ChunkPool(char *memory, std::size_t size, std::size_t chunkSize): _free(nullptr), _chunkSize(chunkSize), _available(0)
+    {
+        for(std::size_t n = size / chunkSize; n > 0; n--) release(memory + (n - 1) * chunkSize);
+    }
+
+    template <std::size_t SIZE>
+        ChunkPool(char(&array)[SIZE], std::size_t chunkSize): ChunkPool(array, SIZE, chunkSize) {}
+
+    /** A free chunk or nullptr if all are taken */
+    char* acquire()
+    {
+        char* chunk = _free;
+        if(chunk) {
+            std::memcpy(&_free, chunk, sizeof(_free));
+            _available--;
+        }
+        return chunk;
+    }
+
+    void release(char* chunk)
+    {
+        std::memcpy(chunk, &_free, sizeof(_free));
+        _free = chunk;
+        _available++;
+    }
+
+    std::size_t chunk_size() { return _chunkSize; }
+
+    /** Number of free chunks */
+    std::size_t available() { return _available; }
+};
+
+/** One piece of a scatter-gather list */
+struct RopeSegment {
+    const char* data;
+    std::size_t size;
+};
+
+/** Builder that appends across a chain of up to MAX_CHUNKS chunks taken from a ChunkPool as it grows,
+ *  so the output is as long as it needs to be and the memory is still bounded. A number is never split
+ *  between two chunks, it goes to the next chunk whole. Each chunk keeps a '\0' after its text.
+ *  The text is read as a list of segments, e.g. for writev() or a DMA descriptor chain, the chunks go
+ *  back to the pool on clear() and on destruction. When the pool or the chain runs out the text is cut */
+template <std::size_t MAX_CHUNKS = 16>
+class RopeBuilder : public CStringBuilder {
+    RopeBuilder(const RopeBuilder&) = delete;
+    RopeBuilder& operator=(const RopeBuilder&) = delete;
+
+private:
+    ChunkPool& _pool;
+    RopeSegment _segments[MAX_CHUNKS];
+    std::size_t _count;
+    char _none[1];
+
+    /* the chunk is full: its text stays as a segment and the builder moves to a new chunk */
+    static void on_flush(CStringBuilder&, void* context)
+    {
+        RopeBuilder* self = static_cast<RopeBuilder*>(context);
+        self->_segments[self->_count - 1].size = self->_cursor;
+        self->next_chunk();
+    }
+
+    void next_chunk()
+    {
+        char* chunk = _count < MAX_CHUNKS ? _pool.acquire() : nullptr;
+
+        if(!chunk) {
+            /* nothing more fits, flushing an empty buffer fails so every add after this one is cut */
+            rebind(_none, 1);
+            _isOverflow = true;
+            return;
+        }
+
+        _segments[_count].data = chunk;
+        _segments[_count].size = 0;
+        _count++;
+        rebind(chunk, _pool.chunk_size());
+    }
+
+    void release()
+    {
+        while(_count) _pool.release(const_cast<char*>(_segments[--_count].data));
+        rebind(_none, 1);
+    }
+
+public:
+    explicit RopeBuilder(ChunkPool& pool): CStringBuilder(_none, 1), _pool(pool), _count(0)
+    {
+        next_chunk();
+        set_flush_hook(on_flush, this);
+    }
+
+    ~RopeBuilder() { release(); }
+
+    /** Segments of the text in order, segment_count() of them */
+    const RopeSegment* segments()
+    {
+        if(_count && _buffer != _none) _segments[_count - 1].size = _cursor;
+        return _segments;
+    }
+
+    std::size_t segment_count() { return _count; }
+
+    /** Fills a writev() style array (iov_base, iov_len), returns the number of entries filled */
+    template <typename IoVec>
+    std::size_t to_iovec(IoVec* iov, std::size_t max)
+    {
+        const RopeSegment* segment = segments();
+        std::size_t n = TCSB_minv(_count, max);
+
+        for(std::size_t i = 0; i < n; i++) {
+            iov[i].iov_base = const_cast<char*>(segment[i].data);
+            iov[i].iov_len = segment[i].size;
+        }
+        return n;
+    }
+
+    /** Length of the whole text */
+    size_t size()
+    {
+        const RopeSegment* segment = segments();
+        std::size_t size = 0;
+
+        for(std::size_t i = 0; i < _count; i++) size += segment[i].size;
+        return size;
+    }
+
+    /** Gives the chunks back and starts over with one chunk */
+    void clear()
+    {
+        release();
+        next_chunk();
+    }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_ROPEBUILDER_HPP
@@ -0,0 +1,219 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_SERIALFRAME_HPP
+#define HEADERLOCK_SERIALFRAME_HPP
+
+#include "CStringBuilder.hpp"
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Builder that COBS-encodes what is added between begin_frame() and end_frame() in place, so the
+ *  buffer is wire-ready: a frame has no zero bytes inside and ends with a 0x00 delimiter.
+ *  Zeros are turned into code bytes as they are added and each code byte is patched when its block ends.
+ *  Use cstr() and size() to send the frames. If the buffer gets full the frame is cut but stays valid */
+class CobsFrameBuilder : public CStringBuilder {
+private:
+    std::size_t _codePos;       /* code byte of the current block */
+    std::size_t _frameStart;
+    bool _inFrame;
+
+    static void on_write(CStringBuilder&, std::size_t from, void* context)
+    {
+        static_cast<CobsFrameBuilder*>(context)->encode(from);
+    }
+
+    std::size_t find_zero(std::size_t i, std::size_t end)
+    {
+#if TCSB_HAS_SWAR
+        for(; end - i >= 8; i += 8) {
+            uint64_t mask = TCSB_Swar::zero_bytes(TCSB_Swar::load(&_buffer[i]));
+            if(mask) return i + TCSB_Swar::first(mask);
+        }
+#endif
+        while(i < end && _buffer[i] != '\0') i++;
+        return i;
+    }
+
+    void encode(std::size_t i)
+    {
+        while(true) {
+            std::size_t blockEnd = _codePos + 255;      /* 254 bytes without a zero end a block */
+            i = find_zero(i, blockEnd < _cursor ? blockEnd : _cursor);
+            if(i == _cursor) break;
+
+            if(i == blockEnd) {
+                /* insert a code byte before this byte, the last byte is dropped if there is no room */
+                if(_cursor == write_limit() - 1) {
+                    _isOverflow = true;
+                    if(i == --_cursor) {
+                        _reserved = _bufferSize - _cursor - 1;      /* nothing else is added to this frame */
+                        break;
+                    }
+                }
+                std::memmove(&_buffer[i + 1], &_buffer[i], _cursor - i);
+                _buffer[_codePos] = (char)0xFF;
+                _cursor++;
+            } else {
+                /* the zero becomes the code byte of the next block */
+                _buffer[_codePos] = (char)(i - _codePos);
+            }
+            _codePos = i++;
+        }
+    }
+
+public:
+    CobsFrameBuilder(char *buffer, std::size_t bufferSize): CStringBuilder(buffer, bufferSize),
+        _codePos(0), _frameStart(0), _inFrame(false) {}
+
+    template <std::size_t SIZE>
+        explicit CobsFrameBuilder(char(&array)[SIZE]): CStringBuilder(array),
+        _codePos(0), _frameStart(0), _inFrame(false) {}
+
+    /** Starts a frame at the cursor, returns false if there is no room for even an empty frame */
+    bool begin_frame()
+    {
+        if(_inFrame) end_frame();
+        if(write_limit() - 1 - _cursor < 2) {
+            _isOverflow = true;
+            return false;
+        }
+
+        _reserved = 1;          /* keeps room for the delimiter */
+        _frameStart = _cursor;
+        _codePos = _cursor;
+        _buffer[_cursor++] = 1;
+        set_write_hook(on_write, this);
+        set_string_end();
+        _inFrame = true;
+        return true;
+    }
+
+    /** Patches the last code byte and adds the delimiter, returns the frame size with the delimiter */
+    size_t end_frame()
+    {
+        if(!_inFrame) return 0;
+
+        set_write_hook(nullptr, nullptr);
+        _buffer[_codePos] = (char)(_cursor - _codePos);
+        _reserved = 0;
+        _buffer[_cursor++] = '\0';
+        set_string_end();
+        _inFrame = false;
+        return _cursor - _frameStart;
+    }
+};
+
+
+/** Builder that SLIP-encodes (RFC 1055) what is added between begin_frame() and end_frame() in place.
+ *  A frame starts and ends with END (0xC0), END and ESC (0xDB) inside are escaped as they are added.
+ *  Use cstr() and size() to send the frames. If the buffer gets full the frame is cut but stays valid */
+class SlipFrameBuilder : public CStringBuilder {
+private:
+    std::size_t _frameStart;
+    bool _inFrame;
+
+    static void on_write(CStringBuilder&, std::size_t from, void* context)
+    {
+        static_cast<SlipFrameBuilder*>(context)->encode(from);
+    }
+
+    std::size_t find_special(std::size_t i)
+    {
+#if TCSB_HAS_SWAR
+        for(; _cursor - i >= 8; i += 8) {
+            uint64_t chunk = TCSB_Swar::load(&_buffer[i]);
+            uint64_t mask = TCSB_Swar::bytes_equal(chunk, (char)0xC0) | TCSB_Swar::bytes_equal(chunk, (char)0xDB);
+            if(mask) return i + TCSB_Swar::first(mask);
+        }
+#endif
+        while(i < _cursor && _buffer[i] != (char)0xC0 && _buffer[i] != (char)0xDB) i++;
+        return i;
+    }
+
+    void encode(std::size_t i)
+    {
+        while((i = find_special(i)) < _cursor) {
+            /* the byte is replaced by two, the last byte is dropped if there is no room */
+            if(_cursor == write_limit() - 1) {
+                _isOverflow = true;
+                if(i == --_cursor) {
+                    _reserved = _bufferSize - _cursor - 1;          /* nothing else is added to this frame */
+                    break;
+                }
+            }
+            std::memmove(&_buffer[i + 2], &_buffer[i + 1], _cursor - i - 1);
+            _buffer[i + 1] = _buffer[i] == (char)0xC0 ? (char)0xDC : (char)0xDD;
+            _buffer[i] = (char)0xDB;
+            _cursor++;
+            i += 2;
+        }
+    }
+
+public:
+    SlipFrameBuilder(char *buffer, std::size_t bufferSize): CStringBuilder(buffer, bufferSize),
+        _frameStart(0), _inFrame(false) {}
+
+    template <std::size_t SIZE>
+        explicit SlipFrameBuilder(char(&array)[SIZE]): CStringBuilder(array),
+        _frameStart(0), _inFrame(false) {}
+
+    /** Starts a frame with END at the cursor, returns false if there is no room for even an empty frame */
+    bool begin_frame()
+    {
+        if(_inFrame) end_frame();
+        if(write_limit() - 1 - _cursor < 2) {
+            _isOverflow = true;
+            return false;
+        }
+
+        _reserved = 1;          /* keeps room for the closing END */
+        _frameStart = _cursor;
+        _buffer[_cursor++] = (char)0xC0;
+        set_write_hook(on_write, this);
+        set_string_end();
+        _inFrame = true;
+        return true;
+    }
+
+    /** Adds the closing END, returns the frame size with both ENDs */
+    size_t end_frame()
+    {
+        if(!_inFrame) return 0;
+
+        set_write_hook(nullptr, nullptr);
+        _reserved = 0;
+        _buffer[_cursor++] = (char)0xC0;
+        set_string_end();
+        _inFrame = false;
+        return _cursor - _frameStart;
+    }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_SERIALFRAME_HPP
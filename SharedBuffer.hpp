@@ -0,0 +1,142 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_SHAREDBUFFER_HPP
+#define HEADERLOCK_SHAREDBUFFER_HPP
+
+#include "CStringBuilder.hpp"
+#include <atomic>
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** One large buffer filled by many threads at once. A writer claims a slice for the maximum length
+ *  of its record with one atomic fetch-add on the shared cursor and formats into it with a
+ *  SharedBuffer::Slice builder. The unused tail of a slice is padded, with '\0' by default, and
+ *  compact() squeezes the '\0' padding out once all writers are done. Records appear in claim order */
+class SharedBuffer {
+    SharedBuffer(const SharedBuffer&) = delete;
+    SharedBuffer& operator=(const SharedBuffer&) = delete;
+
+private:
+    char* _buffer;
+    std::size_t _bufferSize;
+    std::atomic<std::size_t> _cursor;
+
+    std::size_t find_zero(std::size_t i, std::size_t end)
+    {
+#if TCSB_HAS_SWAR
+        for(; end - i >= 8; i += 8) {
+            uint64_t mask = TCSB_Swar::zero_bytes(TCSB_Swar::load(&_buffer[i]));
+            if(mask) return i + TCSB_Swar::first(mask);
+        }
+#endif
+        while(i < end && _buffer[i] != '\0') i++;
+        return i;
+    }
+
+public:
+    SharedBuffer(char *buffer, std::size_t bufferSize): _buffer(buffer), _bufferSize(bufferSize), _cursor(0)
+    {
+        if(_bufferSize) _buffer[0] = '\0';
+    }
+
+    template <std::size_t SIZE>
+        explicit SharedBuffer(char(&array)[SIZE]): SharedBuffer(array, SIZE) {}
+
+    /** Builder over a claimed slice of maxLength chars, padded when finished by finish() or on destruction.
+     *  If the buffer has no room for the slice nothing is written (claimed() is false) */
+    class Slice : public CStringBuilder {
+    private:
+        char _pad;
+        char _none[1];
+
+    public:
+        Slice(SharedBuffer& shared, std::size_t maxLength, char pad = '\0'): CStringBuilder(_none, 1), _pad(pad)
+        {
+            /* + 1 for the '\0' the builder keeps after the text, it is padded over as well */
+            std::size_t offset = shared._cursor.fetch_add(maxLength + 1);
+
+            if(offset + maxLength + 1 <= shared._bufferSize) {
+                rebind(shared._buffer + offset, maxLength + 1);
+            } else if(offset < shared._bufferSize) {
+                /* the part of the buffer this claim got is not left uninitialised */
+                std::memset(shared._buffer + offset, '\0', shared._bufferSize - offset);
+            }
+        }
+
+        ~Slice() { finish(); }
+
+        /** false if the buffer had no room for the slice */
+        bool claimed() { return _buffer != _none; }
+
+        /** Pads the unused tail, nothing can be added after it */
+        void finish()
+        {
+            if(!claimed()) return;
+
+            std::memset(_buffer + _cursor, _pad, _bufferSize - _cursor);
+            rebind(_none, 1);
+        }
+    };
+
+    /** Removes the '\0' padding once all slices are finished and returns the text size.
+     *  The text is '\0' terminated if there is room, slices can be claimed after it again */
+    size_t compact()
+    {
+        std::size_t end = size();
+        std::size_t out = 0;
+
+        for(std::size_t i = 0; i < end; ) {
+            std::size_t zero = find_zero(i, end);
+            if(out != i) std::memmove(&_buffer[out], &_buffer[i], zero - i);
+            out += zero - i;
+
+            for(i = zero; i < end && _buffer[i] == '\0'; i++) {}
+        }
+
+        if(out < _bufferSize) _buffer[out] = '\0';
+        _cursor.store(out);
+        return out;
+    }
+
+    /** Claimed size, with padding */
+    size_t size()
+    {
+        std::size_t cursor = _cursor.load();
+        return cursor < _bufferSize ? cursor : _bufferSize;
+    }
+
+    /** true if a slice did not get room */
+    bool is_overflow() { return _cursor.load() > _bufferSize; }
+
+    /** returns pointer to the buffer */
+    char* cstr() { return _buffer; }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_SHAREDBUFFER_HPP
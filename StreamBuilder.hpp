@@ -0,0 +1,79 @@
+/*  MIT License
+
+Copyright (c) 2016 Dmitry Romanov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+ */
+
+#ifndef HEADERLOCK_STREAMBUILDER_HPP
+#define HEADERLOCK_STREAMBUILDER_HPP
+
+#include "CStringBuilder.hpp"
+
+#if !defined( TCSB_NO_NAMESPACE )
+namespace tcsb {
+#endif
+
+/** Sink of a StreamBuilder as a plain function: UART write, a wrapper over fwrite or socket write */
+typedef void (*StreamSink)(const char* data, std::size_t size);
+
+/** Builder that hands the filled buffer to a sink and goes on from the beginning instead of cutting
+ *  the output, so a small buffer streams any amount of text. Sink is a function pointer or a functor
+ *  called as sink(const char* data, std::size_t size). Numbers are never split between two flushes.
+ *  What is left in the buffer is flushed by flush() and on destruction */
+template <typename Sink = StreamSink>
+class StreamBuilder : public CStringBuilder {
+    StreamBuilder(const StreamBuilder&) = delete;
+    StreamBuilder& operator=(const StreamBuilder&) = delete;
+
+private:
+    Sink _sink;
+
+    static void on_flush(CStringBuilder&, void* context)
+    {
+        StreamBuilder* self = static_cast<StreamBuilder*>(context);
+        self->_sink(self->_buffer, self->_cursor);
+    }
+
+public:
+    StreamBuilder(char *buffer, std::size_t bufferSize, Sink sink): CStringBuilder(buffer, bufferSize), _sink(sink)
+    {
+        set_flush_hook(on_flush, this);
+    }
+
+    template <std::size_t SIZE>
+        StreamBuilder(char(&array)[SIZE], Sink sink): CStringBuilder(array), _sink(sink)
+    {
+        set_flush_hook(on_flush, this);
+    }
+
+    ~StreamBuilder() { flush(); }
+
+    /** Hands what is in the buffer to the sink */
+    void flush() { flush_buffer(); }
+
+    /** The sink, e.g. to read the state of a functor */
+    Sink& sink() { return _sink; }
+};
+
+#if !defined( TCSB_NO_NAMESPACE )
+}   //namespace tcsb {
+#endif
+
+#endif //HEADERLOCK_STREAMBUILDER_HPP
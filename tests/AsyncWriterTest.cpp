@@ -0,0 +1,93 @@
+#include "catch.hpp"
+#include "AsyncWriter.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace tcsb;
+
+static std::string file_text(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+SCENARIO( "Write from a background thread", "[AsyncWriter]" ) {
+    const char* path = "AsyncWriterTest.txt";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+
+    GIVEN( "Several producers and a blocking writer" ) {
+        const int producers = 4;
+        const int lines = 3000;
+        {
+            AsyncWriter<8, 256> writer(fd, true);
+            std::vector<std::thread> threads;
+
+            for(int p = 0; p < producers; p++) {
+                threads.emplace_back([&writer, p, lines]() {
+                    AsyncWriter<8, 256>::Builder sb(writer);
+                    for(int32_t i = 0; i < lines; i++) sb << "producer " << (int32_t)p << " line " << i << " value " << (double)i / 3 << '\n';
+                });
+            }
+            for(std::thread& thread : threads) thread.join();
+
+            writer.wait_idle();
+            REQUIRE(writer.dropped() == 0);
+        }
+
+        THEN("Every line is written whole and in order of its producer") {
+            std::istringstream text(file_text(path));
+            std::string line;
+            int32_t next[producers] = {0};
+            bool whole = true;
+            int count = 0;
+
+            while(std::getline(text, line)) {
+                int p = -1, i = -1;
+                double value = 0;
+                char check[128];
+                whole = whole && std::sscanf(line.c_str(), "producer %d line %d value %lf", &p, &i, &value) == 3
+                        && p >= 0 && p < producers && i == next[p]++;
+                if(whole) {
+                    CStringBuilder sb(check);
+                    sb << "producer " << (int32_t)p << " line " << (int32_t)i << " value " << (double)i / 3;
+                    whole = line == sb.cstr();
+                }
+                count++;
+            }
+
+            REQUIRE(whole);
+            REQUIRE(count == producers * lines);
+        }
+    }
+
+    GIVEN( "A producer that flushes" ) {
+        AsyncWriter<4, 64> writer(fd);
+        {
+            AsyncWriter<4, 64>::Builder sb(writer);
+            sb << "first";
+            sb.flush();
+            writer.wait_idle();
+            REQUIRE(file_text(path) == "first");
+
+            sb << " a line longer than half of the buffer is split when it does not fit " << (int32_t)12345;
+        }
+        writer.wait_idle();
+
+        THEN("What is left goes out when the builder is gone") {
+            REQUIRE(file_text(path) == "first a line longer than half of the buffer is split when it does not fit 12345");
+        }
+    }
+
+    close(fd);
+    std::remove(path);
+}
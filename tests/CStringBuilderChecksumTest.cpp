@@ -0,0 +1,45 @@
+#include "catch.hpp"
+#include "CStringBuilder.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Running checksums of the added text", "[CStringBuilder]" ) {
+    GIVEN( "A builder" ) {
+        char buffer[100];
+        CStringBuilder sb(buffer);
+
+        WHEN("An NMEA sentence is built") {
+            sb << '$';
+            sb.checksum_begin(CStringBuilder::CHECKSUM_XOR8);
+            sb << "GPGLL,5300.97914,N,00259.98174,E,125926,A";
+            sb.checksum_end();
+            sb << '*';
+            sb.add_checksum_hex();
+
+            THEN("The XOR of the body is appended") {
+                REQUIRE(sb.cstr() == std::string("$GPGLL,5300.97914,N,00259.98174,E,125926,A*28"));
+            }
+        }
+
+        WHEN("CRCs are taken over strings and numbers") {
+            sb << "id=";
+            sb.checksum_begin(CStringBuilder::CHECKSUM_CRC16_CCITT);
+            sb << "1234" << (int32_t)56789;
+            uint32_t crc16 = sb.checksum_end();
+
+            sb.checksum_begin(CStringBuilder::CHECKSUM_CRC32C);
+            sb.add("12345", 5);
+            sb.addf(6789.0);
+            sb.checksum_end();
+            sb << ' ';
+            sb.add_checksum_hex();
+
+            THEN("They match the check values") {
+                REQUIRE(crc16 == 0x29B1);
+                REQUIRE(sb.checksum() == 0xE3069283);
+                REQUIRE(sb.cstr() == std::string("id=123456789123456789 E3069283"));
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+
+#include "catch.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <string>
+#include <type_traits>
+#if defined(__SSE4_2__)
+    #include <nmmintrin.h>
+#endif
+#if defined(__SSSE3__)
+    #include <tmmintrin.h>
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h>
+#endif
+
+/* Both table layouts in one test: each inclusion gets a namespace of its own, so the two builders do not
+ * clash with each other or with tcsb::CStringBuilder of the other tests. The system headers are included
+ * above so that the inclusions below do not pull them into the namespaces */
+namespace default_tables {
+    #include "CStringParser.hpp"
+}
+
+#undef HEADERLOCK_CSTRINGBUILDER_HPP
+#undef HEADERLOCK_CSTRINGPARSER_HPP
+#undef TCSB_FP_COMPACT_POWERS
+#undef TCSB_FP_TABLE_ATTR
+#define TCSB_FP_COMPACT_POWERS 1
+#define TCSB_FP_TABLE_SECTION ".rodata.tcsb"
+
+namespace compact_tables {
+    #include "CStringParser.hpp"
+}
+
+typedef default_tables::tcsb::CStringBuilder DefaultBuilder;
+typedef compact_tables::tcsb::CStringBuilder CompactBuilder;
+
+SCENARIO( "Compact power-of-ten tables in a named section", "[CStringBuilder]" ) {
+    GIVEN( "Doubles over the whole exponent range" ) {
+        std::mt19937_64 random(27);
+        char expected[32], actual[32];
+        size_t mismatches = 0;
+        size_t parseMismatches = 0;
+        std::string first;
+
+        for(int i = 0; i < 200000; i++) {
+            uint64_t bits = random();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            int notation = i % 4;
+            DefaultBuilder reference(expected);
+            CompactBuilder compact(actual);
+            reference.fp_notation((DefaultBuilder::FpNotation)notation);
+            compact.fp_notation((CompactBuilder::FpNotation)notation);
+            reference.addf(value);
+            compact.addf(value);
+
+            if(std::strcmp(expected, actual) != 0) {
+                if(mismatches++ == 0) first = std::string(expected) + " != " + actual;
+            }
+
+            double parsedDefault = 0, parsedCompact = 0;
+            default_tables::tcsb::CStringParser(expected, std::strlen(expected)).parsef(parsedDefault);
+            compact_tables::tcsb::CStringParser(expected, std::strlen(expected)).parsef(parsedCompact);
+            if(std::memcmp(&parsedDefault, &parsedCompact, sizeof(double)) != 0) parseMismatches++;
+        }
+
+        THEN("Formatting and parsing give the same results as with the full tables") {
+            INFO(first);
+            REQUIRE(mismatches == 0);
+            REQUIRE(parseMismatches == 0);
+        }
+    }
+}
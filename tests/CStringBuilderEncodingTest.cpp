@@ -0,0 +1,161 @@
+#include "catch.hpp"
+#include "CStringBuilder.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Add binary data as Base64", "[CStringBuilder]" ) {
+    GIVEN( "A buffer big enough" ) {
+        char buffer[100];
+        CStringBuilder sb(buffer);
+
+        WHEN("Every tail length is added") {
+            sb.add_base64("foob", 4);
+            sb.add(' ');
+            sb.add_base64("fooba", 5);
+            sb.add(' ');
+            sb.add_base64("foobar", 6);
+
+            THEN("It is padded to 4 chars") {
+                REQUIRE(sb.cstr() == std::string("Zm9vYg== Zm9vYmE= Zm9vYmFy"));
+            }
+        }
+
+        WHEN("Data is longer than a vector block") {
+            const unsigned char data[] = { 0xfb, 0xff, 0xbf, 0x00, 0x10, 0x83, 0x10, 0x51, 0x87, 0x20, 0x92, 0x8b,
+                                           0x30, 0xd3, 0x8f, 0x41, 0x14, 0x93, 0x51, 0x55, 0x97, 0xfb, 0xef };
+
+            size_t size = sb.add_base64(data, sizeof(data));
+
+            THEN("All 6-bit values are encoded") {
+                REQUIRE(size == 32);
+                REQUIRE(sb.cstr() == std::string("+/+/ABCDEFGHIJKLMNOPQRSTUVWX++8="));
+            }
+        }
+
+        WHEN("Base64url is added") {
+            const unsigned char data[] = { 0xfb, 0xff, 0xbf, 0xfb, 0xef };
+
+            sb.add_base64url(data, sizeof(data));
+
+            THEN("URL-safe chars are used without padding") {
+                REQUIRE(sb.cstr() == std::string("-_-_--8"));
+            }
+        }
+    }
+
+    GIVEN( "A buffer too small" ) {
+        char buffer[11];
+        CStringBuilder sb(buffer);
+
+        WHEN("Base64 does not fit") {
+            size_t size = sb.add_base64("foobarfoobar", 12);
+
+            THEN("It is cut on a 4 chars boundary") {
+                REQUIRE(size == 8);
+                REQUIRE(sb.cstr() == std::string("Zm9vYmFy"));
+                REQUIRE(sb.is_overflow());
+            }
+        }
+    }
+}
+
+SCENARIO( "Add binary data as hex", "[CStringBuilder]" ) {
+    GIVEN( "A buffer big enough" ) {
+        char buffer[300];
+        CStringBuilder sb(buffer);
+        const unsigned char data[] = "Hello world.\x00\x7f\x80\xff" "0123456789abcdef";
+
+        WHEN("Bytes are added with and without a separator") {
+            sb.add_hexbytes(data, 5);
+            sb.add(' ');
+            sb.add_hexbytes(data + 12, 4, ':');
+
+            THEN("They are two upper case digits each") {
+                REQUIRE(sb.cstr() == std::string("48656C6C6F 00:7F:80:FF"));
+            }
+        }
+
+        WHEN("A hex dump is added") {
+            size_t size = sb.add_hexdump(data, sizeof(data) - 1, 0x1F0);
+
+            THEN("Lines have offsets, 16 bytes and an ASCII gutter") {
+                REQUIRE(size == 79 + 79);
+                REQUIRE(sb.cstr() == std::string(
+                    "000001F0  48 65 6C 6C 6F 20 77 6F  72 6C 64 2E 00 7F 80 FF  |Hello world.....|\n"
+                    "00000200  30 31 32 33 34 35 36 37  38 39 61 62 63 64 65 66  |0123456789abcdef|\n"));
+            }
+        }
+
+        WHEN("The last line is short") {
+            sb.add_hexdump(data, 3);
+
+            THEN("The gutter stays aligned") {
+                REQUIRE(sb.cstr() == std::string(
+                    "00000000  48 65 6C                                          |Hel|\n"));
+            }
+        }
+    }
+
+    GIVEN( "A buffer too small" ) {
+        char buffer[100];
+        CStringBuilder sb(buffer);
+        const unsigned char data[40] = { 0 };
+
+        WHEN("Hex does not fit") {
+            size_t size = sb.add_hexbytes(data, 40, ' ');
+
+            THEN("Only whole bytes are added") {
+                REQUIRE(size == 98);
+                REQUIRE(sb.is_overflow());
+            }
+        }
+
+        WHEN("A hex dump does not fit") {
+            size_t size = sb.add_hexdump(data, 40);
+
+            THEN("Only whole lines are added") {
+                REQUIRE(size == 79);
+                REQUIRE(sb.is_overflow());
+            }
+        }
+    }
+}
+
+SCENARIO( "Add escaped strings for URLs and HTML", "[CStringBuilder]" ) {
+    GIVEN( "A buffer big enough" ) {
+        char buffer[200];
+        CStringBuilder sb(buffer);
+
+        WHEN("A query component is percent-encoded") {
+            sb.add_url_encoded("sensor name=T1/ext & ~more_data-v2.0");
+
+            THEN("Only unreserved chars are kept") {
+                REQUIRE(sb.cstr() == std::string("sensor%20name%3DT1%2Fext%20%26%20~more_data-v2.0"));
+            }
+        }
+
+        WHEN("Text is escaped for HTML") {
+            sb.add_xml_escaped("<b class=\"hot\">Tom's 5 > 3 & more</b>");
+
+            THEN("Markup chars become entities") {
+                REQUIRE(sb.cstr() == std::string("&lt;b class=&quot;hot&quot;&gt;Tom&#39;s 5 &gt; 3 &amp; more&lt;/b&gt;"));
+            }
+        }
+    }
+
+    GIVEN( "A buffer too small" ) {
+        char buffer[11];
+        CStringBuilder sb(buffer);
+
+        WHEN("An escape does not fit") {
+            size_t size = sb.add_xml_escaped("a long <tag>");
+
+            THEN("It is not cut") {
+                REQUIRE(size == 7);
+                REQUIRE(sb.cstr() == std::string("a long "));
+                REQUIRE(sb.is_overflow());
+            }
+        }
+    }
+}
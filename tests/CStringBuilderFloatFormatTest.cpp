@@ -0,0 +1,212 @@
+#include "catch.hpp"
+#include "CStringBuilder.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Floating point CStringBuilder extreme values" , "[CStringBuilder]" ) {
+    GIVEN( "A buffer big enough for any double" ) {
+        const size_t bufferSize = 100;
+        char buffer[bufferSize];
+        CStringBuilder sb(buffer, bufferSize);
+
+        WHEN("There is the smallest subnormal double") {
+            size_t len = sb.addf(5e-324);
+
+            THEN("It is normalized correctly") {
+                REQUIRE(sb.cstr() == std::string("5e-324"));
+                REQUIRE(len == 6);
+            }
+        }
+
+        WHEN("There is the smallest normal double") {
+            sb.addf(2.2250738585072014e-308);
+
+            THEN("All digits are there") {
+                REQUIRE(sb.cstr() == std::string("2.2250738585072014e-308"));
+            }
+        }
+
+        WHEN("There is the largest double") {
+            sb.addf(1.7976931348623157e+308);
+
+            THEN("All digits are there") {
+                REQUIRE(sb.cstr() == std::string("1.7976931348623157e+308"));
+            }
+        }
+    }
+}
+
+SCENARIO( "Floating point CStringBuilder notations" , "[CStringBuilder]" ) {
+    GIVEN( "A buffer big enough for any double" ) {
+        const size_t bufferSize = 100;
+        char buffer[bufferSize];
+        CStringBuilder sb(buffer, bufferSize);
+
+        WHEN("Scientific notation is used") {
+            sb.addf(123456, CStringBuilder::FP_SCIENTIFIC);
+            sb.add(' ');
+            sb.addf(3.14, CStringBuilder::FP_SCIENTIFIC);
+
+            THEN("There is always an exponent") {
+                REQUIRE(sb.cstr() == std::string("1.23456e+5 3.14e+0"));
+            }
+        }
+
+        WHEN("Engineering notation is used") {
+            sb.addf(12.5e-6, CStringBuilder::FP_ENGINEERING);
+            sb.add(' ');
+            sb.addf(100, CStringBuilder::FP_ENGINEERING);
+            sb.add(' ');
+            sb.addf(-4700, CStringBuilder::FP_ENGINEERING);
+
+            THEN("Exponent is a multiple of 3") {
+                REQUIRE(sb.cstr() == std::string("12.5e-6 100e+0 -4.7e+3"));
+            }
+        }
+
+        WHEN("SI prefix notation is set for the builder") {
+            sb.fp_notation(CStringBuilder::FP_SI);
+            sb << 4700.0 << " " << 12.5e-6 << " " << 0.5 << " " << 3.14 << " " << 1e30;
+
+            THEN("Prefixes are used within y..Y range") {
+                REQUIRE(sb.cstr() == std::string("4.7k 12.5u 500m 3.14 1e+30"));
+            }
+        }
+    }
+}
+
+SCENARIO( "Floating point CStringBuilder hexadecimal output" , "[CStringBuilder]" ) {
+    GIVEN( "A buffer big enough for any double" ) {
+        const size_t bufferSize = 100;
+        char buffer[bufferSize];
+        CStringBuilder sb(buffer, bufferSize);
+
+        WHEN("There are usual doubles") {
+            sb.addf_hex(1.0);
+            sb.add(' ');
+            sb.addf_hex(3.0);
+            sb.add(' ');
+            sb.addf_hex(-0.1);
+
+            THEN("We get them as printf %a does") {
+                REQUIRE(sb.cstr() == std::string("0x1p+0 0x1.8p+1 -0x1.999999999999ap-4"));
+            }
+        }
+
+        WHEN("There are zero and subnormal doubles") {
+            sb.addf_hex(0.0);
+            sb.add(' ');
+            size_t len = sb.addf_hex(5e-324);
+
+            THEN("Subnormal is not normalized") {
+                REQUIRE(sb.cstr() == std::string("0x0p+0 0x0.0000000000001p-1022"));
+                REQUIRE(len == 23);
+            }
+        }
+
+        WHEN("There are floats") {
+            sb.addf_hex(0.1f);
+            sb.add(' ');
+            sb.addf_hex(1e-45f);
+
+            THEN("Float subnormal is shown normalized as a double") {
+                REQUIRE(sb.cstr() == std::string("0x1.99999ap-4 0x1p-149"));
+            }
+        }
+    }
+}
+
+SCENARIO( "Floating point CStringBuilder arrays" , "[CStringBuilder]" ) {
+    GIVEN( "An array longer than one block" ) {
+        const double values[] = { 1.5, -2, 0, 3.14, 1e-7, 5e-324, 1e100, -0.25, 42, 1/3.0 };
+        const size_t count = sizeof(values) / sizeof(values[0]);
+
+        WHEN("The buffer is big enough") {
+            char buffer[300];
+            CStringBuilder sb(buffer);
+            size_t len = sb.addf_array(values, count, ',');
+
+            THEN("We get the same as adding values one by one") {
+                char expected[300];
+                CStringBuilder ref(expected);
+                for(size_t i = 0; i < count; i++) {
+                    if(i) ref.add(',');
+                    ref.addf(values[i]);
+                }
+
+                REQUIRE(sb.cstr() == std::string(ref.cstr()));
+                REQUIRE(len == ref.size());
+                REQUIRE(sb.cstr() == std::string("1.5,-2,0,3.14,1e-7,5e-324,1e+100,-0.25,42,0.3333333333333333"));
+            }
+        }
+
+        WHEN("The buffer is too small") {
+            char buffer[40];
+            CStringBuilder sb(buffer);
+            sb.addf_array(values, count, ',');
+
+            THEN("Values that fit are there and string is terminated") {
+                REQUIRE(sb.cstr() == std::string("1.5,-2,0,3.14,1e-7"));
+                REQUIRE(sb.is_overflow());
+                REQUIRE(sb.size() < sb.buffer_size());
+            }
+        }
+    }
+}
+
+SCENARIO( "Floating point CStringBuilder longest doubles" , "[CStringBuilder]" ) {
+    GIVEN( "Doubles of 25 chars each" ) {
+        const size_t count = 8;
+        double values[count];
+        for(size_t i = 0; i < count; i++) values[i] = -1.2345678901234567e23;
+
+        WHEN("One is added to a buffer of 25 + 1 bytes") {
+            char buffer[25 + 1];
+            CStringBuilder sb(buffer);
+            size_t len = sb.addf(values[0]);
+
+            THEN("It fills the buffer exactly") {
+                REQUIRE(len == 25);
+                REQUIRE(sb.cstr() == std::string("-123456789012345670000000"));
+                REQUIRE_FALSE(sb.is_overflow());
+            }
+        }
+
+        WHEN("One is added to a buffer of 25 bytes") {
+            char buffer[25];
+            CStringBuilder sb(buffer);
+            size_t len = sb.addf(values[0]);
+
+            THEN("It does not fit and the string is terminated") {
+                REQUIRE(len == 0);
+                REQUIRE(sb.cstr() == std::string(""));
+                REQUIRE(sb.is_overflow());
+            }
+        }
+
+        WHEN("A block of them is added to a buffer of exactly their size") {
+            char buffer[8 * 25 + 7 + 1];
+            CStringBuilder sb(buffer);
+            size_t len = sb.addf_array(values, count, ',');
+
+            THEN("All of them fit") {
+                REQUIRE(len == 8 * 25 + 7);
+                REQUIRE(sb.size() == 8 * 25 + 7);
+                REQUIRE_FALSE(sb.is_overflow());
+            }
+        }
+
+        WHEN("A block of them is added to a buffer of 8 * 25 + 1 bytes") {
+            char buffer[8 * 25 + 1];
+            CStringBuilder sb(buffer);
+            sb.addf_array(values, count, ',');
+
+            THEN("The values that fit are there and the string is terminated") {
+                REQUIRE(sb.size() == 7 * 25 + 6);
+                REQUIRE(sb.is_overflow());
+                REQUIRE(sb.cstr()[sb.size()] == '\0');
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#include "catch.hpp"
+#include "CStringBuilder.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Integer CStringBuilder extreme values", "[CStringBuilder]" ) {
+    GIVEN( "A buffer big enough for any integer" ) {
+        char buffer[100];
+        CStringBuilder sb(buffer);
+
+        WHEN("Add minimum values") {
+            sb << (int8_t)-128 << ' ' << (int64_t)(-9223372036854775807 - 1);
+
+            THEN("the magnitude does not overflow") {
+                REQUIRE(sb.cstr() == std::string("-128 -9223372036854775808"));
+            }
+        }
+    }
+}
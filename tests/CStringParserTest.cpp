@@ -0,0 +1,201 @@
+#include "catch.hpp"
+#include "CStringParser.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Parse integers with CStringParser", "[CStringParser]" ) {
+    GIVEN( "A string built by CStringBuilder" ) {
+        char buffer[100];
+        CStringBuilder sb(buffer);
+        sb << "x=" << (int32_t)-1234 << " " << (uint64_t)18446744073709551614U << ",42";
+
+        CStringParser parser(sb.cstr());
+
+        WHEN("Values are parsed back") {
+            int32_t x = 0;
+            uint64_t big = 0;
+            uint8_t small = 0;
+
+            REQUIRE(parser.skip('x'));
+            REQUIRE(parser.skip('='));
+            size_t len = parser.parse(x);
+            parser.skip_spaces();
+            parser.parse(big);
+            parser.skip(',');
+            parser.parse(small);
+
+            THEN("We get the same values and the cursor is at the end") {
+                REQUIRE(len == 5);
+                REQUIRE(x == -1234);
+                REQUIRE(big == 18446744073709551614U);
+                REQUIRE(small == 42);
+                REQUIRE(parser.at_end());
+            }
+        }
+    }
+
+    GIVEN( "Values at the type limits" ) {
+        WHEN("Values fit") {
+            int8_t i8 = 0;
+            int64_t i64 = 0;
+            uint16_t u16 = 0;
+
+            THEN("They are parsed") {
+                REQUIRE(CStringParser("-128").parse(i8) == 4);
+                REQUIRE(i8 == -128);
+                REQUIRE(CStringParser("-9223372036854775808").parse(i64) == 20);
+                REQUIRE(i64 == INT64_MIN);
+                REQUIRE(CStringParser("+0000000000065535").parse(u16) == 17);
+                REQUIRE(u16 == 65535);
+            }
+        }
+
+        WHEN("Values overflow") {
+            int8_t i8 = 7;
+            uint64_t u64 = 7;
+
+            THEN("Parsing fails and the value is not changed") {
+                REQUIRE(CStringParser("128").parse(i8) == 0);
+                REQUIRE(CStringParser("18446744073709551616").parse(u64) == 0);
+                REQUIRE(CStringParser("-1").parse(u64) == 0);
+                REQUIRE(i8 == 7);
+                REQUIRE(u64 == 7);
+            }
+        }
+
+        WHEN("There are no digits") {
+            CStringParser parser("-x");
+            int32_t value = 7;
+
+            THEN("Parsing fails and the cursor stays") {
+                REQUIRE(parser.parse(value) == 0);
+                REQUIRE(parser.position() == 0);
+                REQUIRE(value == 7);
+            }
+        }
+    }
+}
+
+SCENARIO( "Parse doubles with CStringParser", "[CStringParser]" ) {
+    GIVEN( "Doubles written by addf" ) {
+        const double values[] = { 3.14, -0.0000003, 3000000000000, 1/3.0, 5e-324, 1.7976931348623157e+308, -0.0 };
+        char buffer[300];
+        CStringBuilder sb(buffer);
+        sb.addf_array(values, sizeof(values) / sizeof(values[0]), ' ');
+
+        WHEN("They are parsed back") {
+            CStringParser parser(sb.cstr());
+            bool same = true;
+
+            for(size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+                double value = 1;
+                parser.skip_spaces();
+                REQUIRE(parser.parsef(value));
+                same = same && value == values[i] && std::signbit(value) == std::signbit(values[i]);
+            }
+
+            THEN("We get exactly the same values") {
+                REQUIRE(same);
+                REQUIRE(parser.at_end());
+            }
+        }
+    }
+
+    GIVEN( "Decimal strings that need the exact path" ) {
+        double value = 0;
+
+        WHEN("A value is halfway between two doubles") {
+            size_t len = CStringParser("9007199254740993").parsef(value);
+
+            THEN("It is rounded to even") {
+                REQUIRE(len == 16);
+                REQUIRE(value == 9007199254740992.0);
+            }
+        }
+
+        WHEN("A value has more than 19 digits") {
+            CStringParser("123456789012345678901234567890e-10").parsef(value);
+
+            THEN("It is rounded correctly") {
+                REQUIRE(value == 12345678901234567890.0);
+            }
+        }
+    }
+
+    GIVEN( "Not a number" ) {
+        WHEN("There are no digits") {
+            CStringParser parser(".e5");
+            double value = 7;
+
+            THEN("Parsing fails") {
+                REQUIRE(parser.parsef(value) == 0);
+                REQUIRE(value == 7);
+            }
+        }
+
+        WHEN("Exponent has no digits") {
+            CStringParser parser("2e+x");
+            double value = 0;
+
+            THEN("Exponent is not consumed") {
+                REQUIRE(parser.parsef(value) == 1);
+                REQUIRE(value == 2);
+            }
+        }
+    }
+}
+
+SCENARIO( "Split command lines with CStringTokenizer", "[CStringTokenizer]" ) {
+    GIVEN( "A command line" ) {
+        CStringTokenizer tokens("SET  12 3.5 a_rather_long_name\r\n");
+
+        WHEN("Fields are taken one by one") {
+            CStringToken command = {}, name = {};
+            int32_t channel = 0;
+            double level = 0;
+
+            size_t commandSize = tokens.next(command);
+            tokens.next(channel);
+            tokens.nextf(level);
+            tokens.next(name);
+
+            THEN("They point into the input and numbers are parsed") {
+                REQUIRE(commandSize == 3);
+                REQUIRE(std::string(command.data, command.size) == "SET");
+                REQUIRE(channel == 12);
+                REQUIRE(level == 3.5);
+                REQUIRE(std::string(name.data, name.size) == "a_rather_long_name");
+                REQUIRE(tokens.at_end());
+            }
+        }
+
+        WHEN("A field is not a number") {
+            int32_t value = 7;
+
+            THEN("It is not consumed") {
+                REQUIRE(tokens.next(value) == 0);
+                REQUIRE(value == 7);
+                REQUIRE(tokens.position() == 0);
+            }
+        }
+    }
+
+    GIVEN( "Comma separated values" ) {
+        CStringTokenizer tokens("1,-2,300", ',');
+
+        WHEN("Values do not fit the type") {
+            uint8_t a = 0, b = 0, c = 0;
+
+            THEN("Parsing stops at the value that does not fit") {
+                REQUIRE(tokens.next(a) == 1);
+                REQUIRE(tokens.next(b) == 0);
+                REQUIRE(a == 1);
+                int16_t signedB = 0;
+                REQUIRE(tokens.next(signedB) == 2);
+                REQUIRE(signedB == -2);
+                REQUIRE(tokens.next(c) == 0);
+            }
+        }
+    }
+}
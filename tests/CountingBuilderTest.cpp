@@ -0,0 +1,76 @@
+#include "catch.hpp"
+#include "CountingBuilder.hpp"
+#include <cstdint>
+#include <limits>
+#include <string>
+
+
+using namespace tcsb;
+
+/* the same text through a builder and a dry run */
+template <typename Builder>
+static void format_message(Builder& sb)
+{
+    sb << "id=" << (int32_t)-42 << ' ' << (uint64_t)18446744073709551615U << ' ' << (int8_t)-128
+       << ',' << (int64_t)(-9223372036854775807 - 1) << ';' << true << (uint16_t)0 << (int16_t)9999;
+    sb << " t=" << 3.14159 << ' ' << -0.0 << ' ' << 1e300 << ' ' << std::numeric_limits<double>::infinity();
+    sb.add("abc\0def", 7);
+    sb.add_bytes("x\0y", 3);
+    sb.add_base64("hello world", 11);
+    sb.add_hexdump("0123456789abcdefghij", 20);
+    sb.add_url_encoded("a b&c");
+    sb << (int32_t)10000 << ' ' << (uint32_t)9999 << ' ' << (uint32_t)4294967295U;
+}
+
+SCENARIO( "Measure text without writing it", "[CountingBuilder]" ) {
+    GIVEN( "A counting builder" ) {
+        CountingBuilder counter;
+
+        THEN("It is empty") {
+            REQUIRE(counter.size() == 0);
+        }
+
+        WHEN("A message is counted") {
+            format_message(counter);
+
+            char buffer[512];
+            CStringBuilder sb(buffer);
+            format_message(sb);
+
+            THEN("The size is what the message takes") {
+                REQUIRE(!sb.is_overflow());
+                REQUIRE(counter.size() == sb.size());
+            }
+
+            AND_WHEN("It is reset") {
+                counter.reset();
+                counter << "12" << (int32_t)345;
+
+                THEN("It counts from zero") {
+                    REQUIRE(counter.size() == 5);
+                }
+            }
+        }
+
+        WHEN("Integers of every length are counted") {
+            char buffer[32];
+            bool same = true;
+
+            for(int shift = 0; shift < 63; shift++) {
+                int64_t values[] = {(int64_t)1 << shift, ((int64_t)1 << shift) - 1, -((int64_t)1 << shift),
+                                    (int64_t)(UINT64_C(9999999999999999999) >> shift)};
+                for(int64_t value : values) {
+                    CStringBuilder sb(buffer);
+                    sb << value;
+                    counter.reset();
+                    counter << value;
+                    same = same && counter.size() == sb.size();
+                }
+            }
+
+            THEN("Each length is exact") {
+                REQUIRE(same);
+            }
+        }
+    }
+}
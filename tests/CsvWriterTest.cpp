@@ -0,0 +1,53 @@
+#include "catch.hpp"
+#include "CsvWriter.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Write CSV rows with CsvWriter", "[CsvWriter]" ) {
+    GIVEN( "A builder and a writer over it" ) {
+        char buffer[200];
+        CStringBuilder sb(buffer);
+        CsvWriter csv(sb);
+
+        WHEN("Rows of mixed fields are written") {
+            csv.row((uint32_t)1500, 2.5, "plain text");
+            csv.field((int8_t)-3).empty_field().field("x").end_row();
+
+            THEN("Fields are separated and rows are ended") {
+                REQUIRE(sb.cstr() == std::string("1500,2.5,plain text\n-3,,x\n"));
+            }
+        }
+
+        WHEN("The builder uses SI prefixes") {
+            sb.fp_notation(CStringBuilder::FP_SI);
+            csv.row(4700.0, 0.0000125);
+
+            THEN("Numbers are still plain or scientific") {
+                REQUIRE(sb.cstr() == std::string("4700,1.25e-5\n"));
+            }
+        }
+
+        WHEN("Strings have delimiters, quotes or line breaks") {
+            csv.row("a,b", "say \"hi\" to everybody", "two\nlines", "no quotes needed at all");
+
+            THEN("Only they are quoted and quotes are doubled") {
+                REQUIRE(sb.cstr() == std::string("\"a,b\",\"say \"\"hi\"\" to everybody\",\"two\nlines\",no quotes needed at all\n"));
+            }
+        }
+    }
+
+    GIVEN( "A TSV writer" ) {
+        char buffer[100];
+        CStringBuilder sb(buffer);
+        CsvWriter tsv(sb, '\t');
+
+        WHEN("Strings have commas and tabs") {
+            tsv.row("a,b", "c\td");
+
+            THEN("Only tabs need quoting") {
+                REQUIRE(sb.cstr() == std::string("a,b\t\"c\td\"\n"));
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#include "catch.hpp"
+#include "DmaBuilder.hpp"
+#include <string>
+#include <thread>
+#include <chrono>
+
+
+using namespace tcsb;
+
+/* a thread standing in for the DMA engine: takes one transfer at a time and signals completion */
+struct FakeDma {
+    std::atomic<const char*> data;
+    std::atomic<std::size_t> size;
+    std::atomic<bool> stop;
+    std::atomic<bool> startedWhileBusy;
+    std::string received;
+    int transfers;
+    DmaBuilder<3>* builder;
+
+    FakeDma(): data(nullptr), size(0), stop(false), startedWhileBusy(false), transfers(0), builder(nullptr) {}
+
+    static void transmit(const char* data, std::size_t size, void* context)
+    {
+        FakeDma* dma = static_cast<FakeDma*>(context);
+        if(dma->data.load() != nullptr) dma->startedWhileBusy.store(true);
+        dma->size.store(size);
+        dma->data.store(data);
+    }
+
+    void run()
+    {
+        while(!stop.load()) {
+            const char* pending = data.load();
+            if(!pending) continue;
+
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            received.append(pending, size.load());
+            transfers++;
+            data.store(nullptr);
+            builder->transmit_complete();
+        }
+    }
+};
+
+SCENARIO( "Format while the DMA transmits", "[DmaBuilder]" ) {
+    GIVEN( "A builder over three buffers and a DMA thread" ) {
+        char buffer[3 * 32];
+        char expected[2000];
+        CStringBuilder reference(expected);
+        FakeDma dma;
+        DmaBuilder<3> sb(buffer, FakeDma::transmit, &dma);
+        dma.builder = &sb;
+        std::thread engine(&FakeDma::run, &dma);
+
+        WHEN("Much more than the buffers hold is added") {
+            for(int32_t i = 0; i < 100; i++) {
+                sb << "line " << i << ": ";
+                sb.addf(i * 0.5);
+                sb << '\n';
+                reference << "line " << i << ": ";
+                reference.addf(i * 0.5);
+                reference << '\n';
+            }
+            sb.drain();
+            dma.stop.store(true);
+            engine.join();
+
+            THEN("Everything is transmitted in order") {
+                REQUIRE(!reference.is_overflow());
+                REQUIRE(dma.received == std::string(expected));
+                REQUIRE(dma.transfers > 30);
+                REQUIRE(!dma.startedWhileBusy.load());
+                REQUIRE(sb.idle());
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+#include "IovecBuilder.hpp"
+#include <cstdint>
+#include <string>
+#include <sys/uio.h>
+
+
+using namespace tcsb;
+
+template <typename Builder>
+static std::string gathered(Builder& sb)
+{
+    std::string text;
+    struct iovec* iov = sb.iov();
+    for(size_t i = 0; i < sb.iov_count(); i++) text.append((const char*)iov[i].iov_base, iov[i].iov_len);
+    return text;
+}
+
+SCENARIO( "Reference text instead of copying it", "[IovecBuilder]" ) {
+    GIVEN( "An iovec builder" ) {
+        static const char prefix[] = "level=info msg=";
+        char buffer[32];
+        IovecBuilder<struct iovec> sb(buffer);
+
+        WHEN("Referenced text and numbers are added") {
+            sb.add_ref(prefix);
+            sb << (int32_t)42 << ',' << (int32_t)-7;
+            sb.add_ref(" done\n");
+
+            THEN("The text is referenced and the numbers are in the buffer") {
+                REQUIRE(sb.iov_count() == 3);
+                REQUIRE(sb.iov()[0].iov_base == (void*)prefix);
+                REQUIRE(std::string(sb.cstr()) == "42,-7");
+                REQUIRE(gathered(sb) == "level=info msg=42,-7 done\n");
+                REQUIRE(sb.size() == 26);
+            }
+        }
+
+        WHEN("A const array on the stack is added") {
+            {
+                const char tmp[] = "tmp=";
+                sb << tmp << (int32_t)1;
+                sb.add(tmp);
+            }
+
+            THEN("It is copied, nothing refers to it") {
+                REQUIRE(sb.iov_count() == 1);
+                REQUIRE(std::string(sb.cstr()) == "tmp=1tmp=");
+                REQUIRE(gathered(sb) == "tmp=1tmp=");
+            }
+        }
+
+        WHEN("A writable array and a pointer are added") {
+            char name[8] = "sensor";
+            const char* unit = "mV";
+            sb << name;
+            sb.add(unit, 2);
+            sb.add_ref(unit, 2);
+            name[0] = 'S';
+
+            THEN("They are copied unless referenced on purpose") {
+                REQUIRE(std::string(sb.cstr()) == "sensormV");
+                REQUIRE(gathered(sb) == "sensormVmV");
+            }
+
+            AND_WHEN("It is cleared") {
+                sb.clear();
+                sb << "x" << (int32_t)1;
+
+                THEN("The list starts over") {
+                    REQUIRE(gathered(sb) == "x1");
+                }
+            }
+        }
+    }
+
+    GIVEN( "A short list" ) {
+        char buffer[64];
+        IovecBuilder<struct iovec, 4> sb(buffer);
+
+        WHEN("More references than entries are added") {
+            for(int32_t i = 0; i < 5; i++) {
+                sb.add_ref("id=");
+                sb << i << ' ';
+            }
+
+            THEN("The rest is copied and nothing is lost") {
+                REQUIRE(sb.iov_count() <= 4);
+                REQUIRE(gathered(sb) == "id=0 id=1 id=2 id=3 id=4 ");
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include "catch.hpp"
+#include "JsonWriter.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Write JSON with JsonWriter", "[JsonWriter]" ) {
+    GIVEN( "A builder and a writer over it" ) {
+        char buffer[200];
+        CStringBuilder sb(buffer);
+        JsonWriter json(sb);
+
+        WHEN("Nested objects and arrays are written") {
+            json.begin_object()
+                    .member("t", (uint32_t)1500)
+                    .member("ok", true)
+                    .key("v").begin_array().value(1.5).value((int8_t)-3).value_null().end_array()
+                    .key("pos").begin_object().member("x", 0.25).member("y", (int64_t)-7).end_object()
+                .end_object();
+
+            THEN("Commas are put between values only") {
+                REQUIRE(sb.cstr() == std::string("{\"t\":1500,\"ok\":true,\"v\":[1.5,-3,null],\"pos\":{\"x\":0.25,\"y\":-7}}"));
+            }
+        }
+
+        WHEN("Strings need escaping") {
+            json.begin_array()
+                    .value("a fairly long clean run \"quoted\" \\ tab\t nl\n bell\x07 end")
+                    .value("")
+                .end_array();
+
+            THEN("They are escaped") {
+                REQUIRE(sb.cstr() == std::string("[\"a fairly long clean run \\\"quoted\\\" \\\\ tab\\t nl\\n bell\\u0007 end\",\"\"]"));
+            }
+        }
+
+        WHEN("Arrays are nested deeper than the maximum") {
+            for(int i = 0; i < 40; i++) json.begin_array();
+            json.value((int32_t)1);
+            for(int i = 0; i < 42; i++) json.end_array();
+
+            THEN("The extra levels are refused and overflow is reported") {
+                REQUIRE(sb.cstr() == std::string(31, '[') + "1" + std::string(31, ']'));
+                REQUIRE(sb.is_overflow());
+            }
+        }
+
+        WHEN("Numbers have no JSON representation") {
+            json.begin_array().value(1/0.0).value(std::nan("")).end_array();
+
+            THEN("They are null") {
+                REQUIRE(sb.cstr() == std::string("[null,null]"));
+            }
+        }
+    }
+
+    GIVEN( "A buffer too small for the document" ) {
+        char buffer[10];
+        CStringBuilder sb(buffer);
+        JsonWriter json(sb);
+
+        WHEN("A long string is written") {
+            json.value("0123456789abcdef");
+
+            THEN("Output is cut and overflow is reported") {
+                REQUIRE(sb.cstr() == std::string("\"01234567"));
+                REQUIRE(sb.is_overflow());
+            }
+        }
+    }
+}
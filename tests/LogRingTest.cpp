@@ -0,0 +1,95 @@
+#include "catch.hpp"
+#include "LogRing.hpp"
+#include "CStringParser.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace tcsb;
+
+struct CheckOrder {
+    std::vector<int32_t>* last;     /* last line number seen per producer */
+    bool* ordered;
+
+    void operator()(const char* text, std::size_t size)
+    {
+        CStringTokenizer tokens(text, size);
+        int32_t producer = 0, line = 0;
+        tokens.next(producer);
+        tokens.next(line);
+        if(line <= (*last)[producer]) *ordered = false;
+        (*last)[producer] = line;
+    }
+};
+
+SCENARIO( "Log lines from many producers", "[LogRing]" ) {
+    GIVEN( "A ring" ) {
+        static LogRing<4, 32> ring;
+        std::string drained;
+        auto append = [&drained](const char* text, std::size_t size) { drained.append(text, size).append("|"); };
+
+        WHEN("Records are committed out of order") {
+            LogRing<4, 32>::Record first(ring);
+            {
+                LogRing<4, 32>::Record second(ring);
+                second << "second";
+            }
+            size_t before = ring.drain(append);
+            first << "first " << (int32_t)1;
+            first.commit();
+            size_t after = ring.drain(append);
+
+            THEN("They are drained in reservation order") {
+                REQUIRE(before == 0);
+                REQUIRE(after == 2);
+                REQUIRE(drained == "first 1|second|");
+            }
+        }
+
+        WHEN("The ring is full") {
+            for(int32_t i = 0; i < 6; i++) {
+                LogRing<4, 32>::Record line(ring);
+                line << "line " << i;
+                if(i >= 4) REQUIRE(!line.reserved());
+            }
+            ring.drain(append);
+
+            THEN("New records are dropped") {
+                REQUIRE(drained == "line 0|line 1|line 2|line 3|");
+                REQUIRE(ring.dropped() == 2);
+            }
+        }
+    }
+
+    GIVEN( "Producer threads and a consumer" ) {
+        static LogRing<256, 64> ring;
+        const int32_t producers = 4;
+        const int32_t lines = 20000;
+        std::vector<int32_t> last(producers, -1);
+        bool ordered = true;
+        std::atomic<int> running(producers);
+        std::size_t drained = 0;
+
+        WHEN("All produce at once") {
+            std::vector<std::thread> threads;
+            for(int32_t p = 0; p < producers; p++) {
+                threads.emplace_back([p, lines, &running]() {
+                    for(int32_t i = 0; i < lines; i++) {
+                        LogRing<256, 64>::Record line(ring);
+                        line << p << ' ' << i << " some log text";
+                    }
+                    running--;
+                });
+            }
+            while(running.load()) drained += ring.drain(CheckOrder{&last, &ordered});
+            for(auto& thread: threads) thread.join();
+            drained += ring.drain(CheckOrder{&last, &ordered});
+
+            THEN("Every record is drained or counted as dropped, in order per producer") {
+                REQUIRE(drained + ring.dropped() == (std::size_t)(producers * lines));
+                REQUIRE(ordered);
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "catch.hpp"
+#include "MappedFileBuilder.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace tcsb;
+
+static std::string file_text(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+SCENARIO( "Format into a memory mapped file", "[MappedFileBuilder]" ) {
+    GIVEN( "A file that grows one page at a time" ) {
+        const char* path = "MappedFileBuilderTest.txt";
+        std::vector<char> expected(1 << 20);
+        CStringBuilder reference(expected.data(), expected.size());
+
+        WHEN("More than a page of text is added") {
+            {
+                MappedFileBuilder sb(path, 1);
+                REQUIRE(sb.is_open());
+
+                for(int32_t i = 0; i < 20000; i++) {
+                    sb << "row " << i << ',' << (int64_t)i * -987654321 << ',' << (double)i / 8 << '\n';
+                    reference << "row " << i << ',' << (int64_t)i * -987654321 << ',' << (double)i / 8 << '\n';
+                }
+
+                REQUIRE(sb.size() == reference.size());
+                REQUIRE(std::string(sb.cstr(), sb.size()) == std::string(reference.cstr()));
+                REQUIRE(!sb.is_overflow());
+            }
+
+            THEN("The file has exactly the text") {
+                REQUIRE(file_text(path) == std::string(reference.cstr()));
+            }
+        }
+
+        WHEN("Nothing is added") {
+            MappedFileBuilder sb(path);
+            REQUIRE(sb.close());
+
+            THEN("The file is empty") {
+                REQUIRE(sb.size() == 0);
+                REQUIRE(file_text(path).empty());
+            }
+        }
+
+        std::remove(path);
+    }
+
+    GIVEN( "A path that can not be created" ) {
+        MappedFileBuilder sb("no/such/directory/file.txt");
+        sb << "text";
+
+        THEN("Nothing is written") {
+            REQUIRE(!sb.is_open());
+            REQUIRE(sb.size() == 0);
+        }
+    }
+}
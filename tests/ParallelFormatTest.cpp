@@ -0,0 +1,116 @@
+#include "catch.hpp"
+#include "ParallelFormat.hpp"
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace tcsb;
+
+template <typename T>
+static std::string serial_text(const std::vector<T>& values, CStringBuilder::FpNotation notation = CStringBuilder::FP_AUTO)
+{
+    std::vector<char> buffer(values.size() * 26 + 1);
+    CStringBuilder sb(buffer.data(), buffer.size());
+    sb.fp_notation(notation);
+    for(size_t i = 0; i < values.size(); i++) {
+        if(i) sb.add(',');
+        sb << values[i];
+    }
+    return std::string(sb.cstr(), sb.size());
+}
+
+SCENARIO( "Format arrays with several threads", "[ParallelFormat]" ) {
+    std::mt19937_64 random(45);
+
+    GIVEN( "Integers of every length" ) {
+        std::vector<int64_t> values(20000);
+        for(size_t i = 0; i < values.size(); i++) values[i] = (int64_t)random() >> (random() % 64);
+        values[7] = std::numeric_limits<int64_t>::min();
+        values[8] = std::numeric_limits<int64_t>::max();
+        values[9] = 0;
+
+        std::string expected = serial_text(values);
+        std::vector<char> buffer(expected.size() + 3);
+        CStringBuilder sb(buffer.data(), buffer.size());
+        sb << "v=";
+
+        THEN("The text is the same as added one by one") {
+            REQUIRE(ParallelFormat::add_array(sb, values.data(), values.size(), ',', 4) == expected.size());
+            REQUIRE(std::string(sb.cstr()) == "v=" + expected);
+            REQUIRE(!sb.is_overflow());
+        }
+
+        WHEN("The buffer is too small") {
+            CStringBuilder small(buffer.data(), buffer.size() - 1);
+            small << "v=";
+            ParallelFormat::add_array(small, values.data(), values.size(), ',', 4);
+
+            std::vector<char> serialBuffer(buffer.size() - 1);
+            CStringBuilder serial(serialBuffer.data(), serialBuffer.size());
+            serial << "v=";
+            for(size_t i = 0; i < values.size() && !serial.is_overflow(); i++) {
+                if(i) serial.add(',');
+                serial << values[i];
+            }
+
+            THEN("It is filled as the serial way does") {
+                REQUIRE(small.is_overflow());
+                REQUIRE(std::string(small.cstr()) == std::string(serial.cstr()));
+            }
+        }
+    }
+
+    GIVEN( "A builder that already had something cut" ) {
+        char buffer[16];
+        CStringBuilder sb(buffer);
+        sb << "x=";
+        sb.addf(0.1);
+        int32_t values[] = {1, 2, 3};
+
+        THEN("The values are added as one by one adds would") {
+            REQUIRE(sb.is_overflow());
+            REQUIRE(ParallelFormat::add_array(sb, values, 3, ',') == 5);
+            REQUIRE(std::string(sb.cstr()) == "x=1,2,3");
+        }
+    }
+
+    GIVEN( "32 bit integers" ) {
+        std::vector<int32_t> values(5000);
+        for(size_t i = 0; i < values.size(); i++) values[i] = (int32_t)random();
+        values[0] = std::numeric_limits<int32_t>::min();
+
+        std::string expected = serial_text(values);
+        std::vector<char> buffer(expected.size() + 1);
+        CStringBuilder sb(buffer.data(), buffer.size());
+
+        THEN("The text is the same as added one by one") {
+            REQUIRE(ParallelFormat::add_array(sb, values.data(), values.size(), ',', 3) == expected.size());
+            REQUIRE(std::string(sb.cstr()) == expected);
+        }
+    }
+
+    GIVEN( "Doubles" ) {
+        std::vector<double> values(10000);
+        for(size_t i = 0; i < values.size(); i++) values[i] = (double)(int64_t)random() / (double)(1 + random() % 100000);
+        /* the longest doubles, 25 chars in FP_AUTO, at the start, in the middle and at the end */
+        values[0] = values[5000] = -1.2345678901234567e23;
+        values[9999] = 1.2345678901234567e23;
+
+        THEN("The text is the same as added one by one in every notation") {
+            CStringBuilder::FpNotation notations[] = {CStringBuilder::FP_AUTO, CStringBuilder::FP_SCIENTIFIC,
+                                                      CStringBuilder::FP_ENGINEERING, CStringBuilder::FP_SI};
+            for(CStringBuilder::FpNotation notation : notations) {
+                std::string expected = serial_text(values, notation);
+                std::vector<char> buffer(expected.size() + 1);
+                CStringBuilder sb(buffer.data(), buffer.size());
+                sb.fp_notation(notation);
+
+                REQUIRE(ParallelFormat::add_array(sb, values.data(), values.size(), ',', 4) == expected.size());
+                REQUIRE(std::string(sb.cstr()) == expected);
+            }
+        }
+    }
+}
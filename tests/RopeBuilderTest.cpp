@@ -0,0 +1,105 @@
+#include "catch.hpp"
+#include "RopeBuilder.hpp"
+#include <cstdint>
+#include <string>
+#include <sys/uio.h>
+
+
+using namespace tcsb;
+
+static std::string joined(RopeBuilder<8>& rope)
+{
+    std::string text;
+    const RopeSegment* segment = rope.segments();
+    for(size_t i = 0; i < rope.segment_count(); i++) text.append(segment[i].data, segment[i].size);
+    return text;
+}
+
+SCENARIO( "Append across a chain of chunks", "[RopeBuilder]" ) {
+    GIVEN( "A pool of 16 byte chunks" ) {
+        char memory[6 * 16];
+        ChunkPool pool(memory, 16);
+
+        REQUIRE(pool.available() == 6);
+
+        WHEN("Short text is added") {
+            RopeBuilder<8> rope(pool);
+            rope << "abc" << (int32_t)12;
+
+            THEN("It takes one chunk") {
+                REQUIRE(rope.segment_count() == 1);
+                REQUIRE(rope.size() == 5);
+                REQUIRE(std::string(rope.cstr()) == "abc12");
+                REQUIRE(pool.available() == 5);
+            }
+        }
+
+        WHEN("Text grows over several chunks") {
+            RopeBuilder<8> rope(pool);
+            rope << "0123456789abc" << (int32_t)-123456 << ',' << "the quick brown fox";
+
+            THEN("The segments hold the whole text and the number is not split") {
+                REQUIRE(joined(rope) == "0123456789abc-123456,the quick brown fox");
+                REQUIRE(std::string(rope.segments()[0].data, rope.segments()[0].size) == "0123456789abc");
+                REQUIRE(std::string(rope.segments()[1].data, 7) == "-123456");
+                REQUIRE(!rope.is_overflow());
+            }
+
+            THEN("They fill an iovec array") {
+                struct iovec iov[8];
+                size_t n = rope.to_iovec(iov, 8);
+                REQUIRE(n == rope.segment_count());
+                REQUIRE(iov[0].iov_len == 13);
+                REQUIRE(std::string((char*)iov[1].iov_base, iov[1].iov_len) == rope.segments()[1].data);
+            }
+
+            AND_WHEN("It is cleared") {
+                rope.clear();
+
+                THEN("The chunks go back to the pool") {
+                    REQUIRE(rope.segment_count() == 1);
+                    REQUIRE(rope.size() == 0);
+                    REQUIRE(pool.available() == 5);
+                }
+            }
+        }
+
+        WHEN("The pool runs out") {
+            RopeBuilder<8> rope(pool);
+            for(int32_t i = 0; i < 100; i++) rope << i << ' ';
+
+            THEN("The text is cut at a chunk end") {
+                REQUIRE(rope.is_overflow());
+                REQUIRE(rope.segment_count() == 6);
+                REQUIRE(pool.available() == 0);
+                REQUIRE(joined(rope) == "0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 "
+                                        "26 27 28 29 30 31 32 ");
+            }
+        }
+
+        WHEN("The pool is already empty") {
+            RopeBuilder<8> first(pool);
+            for(int32_t i = 0; i < 100; i++) first << i << ' ';
+            RopeBuilder<8> rope(pool);
+            rope << "abc";
+
+            THEN("The builder reports the overflow") {
+                REQUIRE(rope.segment_count() == 0);
+                REQUIRE(rope.size() == 0);
+                REQUIRE(rope.is_overflow());
+            }
+
+            AND_WHEN("It is cleared") {
+                rope.clear();
+
+                THEN("It still reports the overflow") {
+                    REQUIRE(rope.is_overflow());
+                }
+            }
+        }
+
+        THEN("All chunks are back after the builders are gone") {
+            REQUIRE(pool.available() == 6);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "catch.hpp"
+#include "SerialFrame.hpp"
+
+
+using namespace tcsb;
+
+SCENARIO( "Build COBS frames in place", "[SerialFrame]" ) {
+    GIVEN( "A COBS builder" ) {
+        char buffer[600];
+        CobsFrameBuilder sb(buffer);
+
+        WHEN("Text is added in a frame") {
+            sb.begin_frame();
+            sb << "T=" << (int16_t)25;
+            size_t bufferSize = sb.buffer_size();
+            size_t size = sb.end_frame();
+
+            THEN("It gets a code byte and a delimiter") {
+                REQUIRE(bufferSize == sizeof(buffer));
+                REQUIRE(size == 6);
+                REQUIRE(std::string(buffer, sb.size()) == std::string("\x05T=25\0", 6));
+            }
+        }
+
+        WHEN("Zeros are added in pieces") {
+            sb.begin_frame();
+            sb.add_bytes("\x11\x22\0", 3);
+            sb.add_bytes("\x33", 1);
+            sb.end_frame();
+            sb.begin_frame();
+            sb.add_bytes("\0\0", 2);
+            sb.end_frame();
+
+            THEN("Code bytes are patched") {
+                REQUIRE(std::string(buffer, sb.size()) == std::string("\x03\x11\x22\x02\x33\0" "\x01\x01\x01\0", 10));
+            }
+        }
+
+        WHEN("A block has more than 254 bytes without zero") {
+            char data[255];
+            for(int i = 0; i < 255; i++) data[i] = (char)(i + 1);
+
+            sb.begin_frame();
+            sb.add_bytes(data, 255);
+            size_t size = sb.end_frame();
+
+            THEN("A code byte is inserted") {
+                REQUIRE(size == 258);
+                REQUIRE((unsigned char)buffer[0] == 0xFF);
+                REQUIRE(std::string(buffer + 1, 254) == std::string(data, 254));
+                REQUIRE(std::string(buffer + 255, 3) == std::string("\x02\xFF\0", 3));
+            }
+        }
+    }
+
+    GIVEN( "A small COBS builder" ) {
+        char buffer[8];
+        CobsFrameBuilder sb(buffer);
+
+        WHEN("The frame does not fit") {
+            sb.begin_frame();
+            sb.add_bytes("long text", 9);
+            sb.end_frame();
+
+            THEN("It is cut and still delimited") {
+                REQUIRE(std::string(buffer, sb.size()) == std::string("\x06long \0", 7));
+                REQUIRE(sb.is_overflow());
+            }
+        }
+    }
+}
+
+SCENARIO( "Build SLIP frames in place", "[SerialFrame]" ) {
+    GIVEN( "A SLIP builder" ) {
+        char buffer[100];
+        SlipFrameBuilder sb(buffer);
+
+        WHEN("Special bytes are added in a frame") {
+            sb.begin_frame();
+            sb << "ab";
+            sb.add_bytes("\xC0" "c\xDB", 3);
+            size_t size = sb.end_frame();
+
+            THEN("They are escaped and the frame has ENDs") {
+                REQUIRE(size == 9);
+                REQUIRE(std::string(buffer, sb.size()) == std::string("\xC0" "ab\xDB\xDC" "c\xDB\xDD\xC0"));
+            }
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#include "catch.hpp"
+#include "SharedBuffer.hpp"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace tcsb;
+
+SCENARIO( "Fill one buffer from many writers", "[SharedBuffer]" ) {
+    GIVEN( "A shared buffer" ) {
+        char buffer[64];
+        SharedBuffer shared(buffer);
+
+        WHEN("Slices are padded with spaces") {
+            {
+                SharedBuffer::Slice a(shared, 8, ' ');
+                SharedBuffer::Slice b(shared, 8, ' ');
+                b << "b=" << (int32_t)-2;
+                a << "a=" << (int32_t)1;
+            }
+
+            THEN("Records are fixed width in claim order") {
+                REQUIRE(std::string(buffer, shared.size()) == "a=1      b=-2     ");
+            }
+        }
+
+        WHEN("Slices are compacted") {
+            {
+                SharedBuffer::Slice a(shared, 20);
+                SharedBuffer::Slice b(shared, 20);
+                a << "first;";
+                b << "second;";
+            }
+            size_t size = shared.compact();
+
+            THEN("The padding is removed") {
+                REQUIRE(size == 13);
+                REQUIRE(std::string(shared.cstr()) == "first;second;");
+            }
+        }
+
+        WHEN("A slice does not fit") {
+            SharedBuffer::Slice a(shared, 40);
+            SharedBuffer::Slice b(shared, 40);
+            a << "kept";
+            b << "lost";
+            a.finish();
+            b.finish();
+
+            THEN("It is dropped and the rest is compacted away") {
+                REQUIRE(!b.claimed());
+                REQUIRE(shared.is_overflow());
+                REQUIRE(shared.compact() == 4);
+                REQUIRE(std::string(shared.cstr()) == "kept");
+            }
+        }
+    }
+
+    GIVEN( "Worker threads and a large buffer" ) {
+        static char buffer[1 << 20];
+        SharedBuffer shared(buffer);
+        const int32_t workers = 4;
+        const int32_t records = 5000;
+
+        WHEN("All write records at once") {
+            std::vector<std::thread> threads;
+            for(int32_t w = 0; w < workers; w++) {
+                threads.emplace_back([w, records, &shared]() {
+                    for(int32_t i = 0; i < records; i++) {
+                        SharedBuffer::Slice record(shared, 40);
+                        record << w << ',' << i << ',';
+                        record.addf(i * 0.25);
+                        record << '\n';
+                    }
+                });
+            }
+            for(auto& thread: threads) thread.join();
+            shared.compact();
+
+            THEN("Every record is there once") {
+                std::vector<std::string> lines;
+                const char* text = shared.cstr();
+                for(const char* line = text; *line; ) {
+                    const char* end = std::strchr(line, '\n');
+                    lines.push_back(std::string(line, end));
+                    line = end + 1;
+                }
+
+                std::vector<std::string> expected;
+                char line[40];
+                for(int32_t w = 0; w < workers; w++) {
+                    for(int32_t i = 0; i < records; i++) {
+                        CStringBuilder sb(line);
+                        sb << w << ',' << i << ',';
+                        sb.addf(i * 0.25);
+                        expected.push_back(sb.cstr());
+                    }
+                }
+
+                std::sort(lines.begin(), lines.end());
+                std::sort(expected.begin(), expected.end());
+                REQUIRE(!shared.is_overflow());
+                REQUIRE(lines == expected);
+            }
+        }
+    }
+}
+
+SCENARIO( "Share an empty buffer", "[SharedBuffer]" ) {
+    GIVEN( "A buffer of no size" ) {
+        char guard[2] = {'x', 'y'};
+        SharedBuffer shared(guard, 0);
+
+        WHEN("A slice is claimed") {
+            {
+                SharedBuffer::Slice slice(shared, 4);
+                slice << "abc";
+                REQUIRE(!slice.claimed());
+            }
+
+            THEN("Nothing is written") {
+                REQUIRE(shared.is_overflow());
+                REQUIRE(shared.compact() == 0);
+                REQUIRE(guard[0] == 'x');
+            }
+        }
+    }
+}
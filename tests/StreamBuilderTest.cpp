@@ -0,0 +1,90 @@
+#include "catch.hpp"
+#include "StreamBuilder.hpp"
+#include <string>
+
+
+using namespace tcsb;
+
+struct CollectSink {
+    std::string* text;
+    std::string* chunks;
+
+    void operator()(const char* data, std::size_t size)
+    {
+        text->append(data, size);
+        chunks->append(data, size).append("|");
+    }
+};
+
+static std::string streamed;
+
+static void string_sink(const char* data, std::size_t size)
+{
+    streamed.append(data, size);
+}
+
+SCENARIO( "Stream output through a small buffer", "[StreamBuilder]" ) {
+    GIVEN( "A stream builder with a functor sink" ) {
+        std::string text, chunks;
+        char buffer[16];
+
+        WHEN("More text than the buffer holds is added") {
+            {
+                StreamBuilder<CollectSink> sb(buffer, CollectSink{&text, &chunks});
+                for(int i = 0; i < 10; i++) {
+                    sb << (int32_t)(123456 * i) << ';';
+                    sb.addf(i / 8.0);
+                    sb << ';';
+                }
+                sb << "and a string longer than the buffer";
+            }
+
+            THEN("Everything reaches the sink and numbers are not split") {
+                REQUIRE(text == "0;0;123456;0.125;246912;0.25;370368;0.375;493824;0.5;617280;0.625;"
+                                "740736;0.75;864192;0.875;987648;1;1111104;1.125;and a string longer than the buffer");
+                REQUIRE(chunks == "0;0;123456;|0.125;246912;|0.25;370368;|0.375;493824;|0.5;617280;|0.625;740736;|0.75;864192;|"
+                                  "0.875;987648;1;|1111104;1.125;a|nd a string lon|ger than the bu|ffer|");
+            }
+        }
+    }
+
+    GIVEN( "A stream builder with a 30 byte buffer" ) {
+        std::string text, chunks;
+        char buffer[30];
+
+        WHEN("The longest double is added near the end of the buffer") {
+            {
+                StreamBuilder<CollectSink> sb(buffer, CollectSink{&text, &chunks});
+                sb << "0123456789";
+                sb.addf(-1.2345678901234567e23);
+                sb << ';';
+            }
+
+            THEN("It is formatted aside in one piece") {
+                REQUIRE(text == "0123456789-123456789012345670000000;");
+                REQUIRE(chunks == "0123456789|-123456789012345670000000;|");
+            }
+        }
+    }
+
+    GIVEN( "A stream builder with a function sink" ) {
+        char buffer[20];
+        streamed.clear();
+
+        WHEN("Binary data is encoded") {
+            const unsigned char data[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+            {
+                StreamBuilder<> sb(buffer, string_sink);
+                sb.add_base64(data, sizeof(data) - 1);
+                sb << ' ';
+                sb.add_hexbytes(data, 10, ':');
+                sb.flush();
+                REQUIRE(sb.size() == 0);
+            }
+
+            THEN("It is not cut") {
+                REQUIRE(streamed == "MDEyMzQ1Njc4OWFiY2RlZmdoaWprbG1ub3BxcnN0dXZ3eHl6 30:31:32:33:34:35:36:37:38:39");
+            }
+        }
+    }
+}